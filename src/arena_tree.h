@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Binary tree kept in one vector.
+// Nodes refer to their children with 32-bit indices instead of pointers,
+// there are no parent links, and the whole tree is one allocation which
+// goes away with the tree. Iteration keeps the way back in the iterator
+// (a stack of indices), so nothing is chased upwards.
+// A tree which doesn't change anymore can be copied into a layout keeping
+// the nodes visited together close to each other in memory.
+
+enum class tree_layout {
+  as_built,// the order the nodes were added in
+  depth_first,// a node, its left subtree, its right subtree
+  eytzinger,// breadth first: in a complete tree children of node i are 2i+1 and 2i+2
+  van_emde_boas,// the top half of the levels, then every subtree below it, recursively
+};
+
+template<typename T> class ArenaTree
+{
+public:
+  using index = std::uint32_t;
+  static constexpr index none = UINT32_MAX;
+
+  struct node
+  {
+    T value;
+    index left = none;
+    index right = none;
+  };
+
+  /// walks the tree in order, the same order as PreOrderIterator of BinaryTree
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    iterator() = default;
+    iterator(const ArenaTree *tree, index from) : tree{ tree } { descend(from); }
+
+    reference operator*() const { return tree->nodes[current].value; }
+    pointer operator->() const { return &tree->nodes[current].value; }
+    /// index of the current node
+    [[nodiscard]] index position() const { return current; }
+
+    iterator &operator++()
+    {
+      index right = tree->nodes[current].right;
+      if (right != none) {
+        descend(right);
+      } else if (pending.empty()) {
+        current = none;
+      } else {
+        current = pending.back();
+        pending.pop_back();
+      }
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator was = *this;
+      ++*this;
+      return was;
+    }
+
+    bool operator==(const iterator &other) const { return current == other.current; }
+
+  private:
+    // goes to the leftmost node under `from`, remembering the nodes to come back to
+    void descend(index from)
+    {
+      current = from;
+      if (current == none) { return; }
+      while (tree->nodes[current].left != none) {
+        pending.push_back(current);
+        current = tree->nodes[current].left;
+      }
+    }
+
+    const ArenaTree *tree = nullptr;
+    index current = none;
+    std::vector<index> pending;// nodes whose left subtree is being walked
+  };
+
+  ArenaTree() = default;
+
+  /// balanced search tree of sorted values; it is complete (all levels
+  /// but the last one are full), so the Eytzinger layout is exact
+  static ArenaTree from_sorted(std::span<const T> sorted, tree_layout layout = tree_layout::eytzinger)
+  {
+    const std::size_t n = sorted.size();
+    if (n >= none) { throw std::length_error("ArenaTree: out of indices"); }
+
+    // k is a 1-based position in breadth first order, children of k are 2k and 2k+1;
+    // the in order walk over positions gives every position its sorted value
+    std::vector<index> rank(n);
+    auto leftmost = [n](std::uint64_t pos) {
+      while (2 * pos <= n) { pos *= 2; }
+      return pos;
+    };
+    std::uint64_t k = n ? leftmost(1) : 0;
+    for (index i = 0; k != 0; ++i) {
+      rank[k - 1] = i;
+      // after a right subtree is done go up over all right children, then once more
+      k = 2 * k + 1 <= n ? leftmost(2 * k + 1) : k >> (std::countr_one(k) + 1);
+    }
+
+    ArenaTree tree;
+    tree.nodes.reserve(n);
+    for (std::uint64_t pos = 1; pos <= n; ++pos) {
+      tree.nodes.push_back({ sorted[rank[pos - 1]],
+        2 * pos <= n ? static_cast<index>(2 * pos - 1) : none,
+        2 * pos + 1 <= n ? static_cast<index>(2 * pos) : none });
+    }
+    tree.top = n ? 0 : none;
+    tree.implicit = true;
+    return layout == tree_layout::eytzinger ? tree : tree.relayout(layout);
+  }
+
+  /// adds a node over already added children and makes it the root,
+  /// so a tree is built bottom up like nested Node constructors
+  index add(T value, index left = none, index right = none)
+  {
+    if (nodes.size() >= none) { throw std::length_error("ArenaTree: out of indices"); }
+    nodes.push_back({ std::move(value), left, right });
+    top = static_cast<index>(nodes.size() - 1);
+    implicit = false;
+    return top;
+  }
+
+  void reserve(std::size_t count) { nodes.reserve(count); }
+  void set_root(index root)
+  {
+    top = root;
+    implicit = false;
+  }
+
+  [[nodiscard]] index root() const { return top; }
+  [[nodiscard]] std::size_t size() const { return nodes.size(); }
+  [[nodiscard]] const node &operator[](index i) const { return nodes[i]; }
+  /// links of a tree made by from_sorted() in the Eytzinger layout must stay as they are
+  [[nodiscard]] node &operator[](index i) { return nodes[i]; }
+
+  [[nodiscard]] iterator begin() const { return iterator{ this, top }; }
+  [[nodiscard]] iterator end() const { return iterator{}; }
+
+  /// node equal to key in a search tree (smaller values on the left), none if there is no such node
+  [[nodiscard]] index find(const T &key) const
+  {
+    if (implicit) { return find_implicit(key); }
+    index i = top;
+    while (i != none) {
+      const node &n = nodes[i];
+      if (key < n.value) {
+        i = n.left;
+      } else if (n.value < key) {
+        i = n.right;
+      } else {
+        return i;
+      }
+    }
+    return none;
+  }
+
+  /// number of levels
+  [[nodiscard]] std::size_t height() const
+  {
+    std::size_t levels = 0;
+    std::vector<index> level, next;
+    if (top != none) { level.push_back(top); }
+    for (; !level.empty(); ++levels, level.swap(next)) {
+      next.clear();
+      for (index i : level) {
+        if (nodes[i].left != none) { next.push_back(nodes[i].left); }
+        if (nodes[i].right != none) { next.push_back(nodes[i].right); }
+      }
+    }
+    return levels;
+  }
+
+  /// copy of the tree with its nodes in another order; nodes which can't
+  /// be reached from the root are left out, the root becomes node 0
+  [[nodiscard]] ArenaTree relayout(tree_layout layout) const
+  {
+    if (layout == tree_layout::as_built) { return *this; }
+
+    std::vector<index> order;// old indices in the new order
+    order.reserve(nodes.size());
+    if (top != none) {
+      switch (layout) {
+      case tree_layout::depth_first:
+        for_each_pre_order(top, [&order](index i) { order.push_back(i); });
+        break;
+      case tree_layout::eytzinger:
+        order.push_back(top);
+        for (std::size_t head = 0; head < order.size(); ++head) {
+          const node &n = nodes[order[head]];
+          if (n.left != none) { order.push_back(n.left); }
+          if (n.right != none) { order.push_back(n.right); }
+        }
+        break;
+      case tree_layout::van_emde_boas:
+        van_emde_boas(top, height(), order);
+        break;
+      case tree_layout::as_built:
+        break;
+      }
+    }
+
+    std::vector<index> moved(nodes.size(), none);
+    for (std::size_t i = 0; i < order.size(); ++i) { moved[order[i]] = static_cast<index>(i); }
+    auto at = [&moved](index old) { return old == none ? none : moved[old]; };
+
+    ArenaTree tree;
+    tree.nodes.reserve(order.size());
+    for (index old : order) { tree.nodes.push_back({ nodes[old].value, at(nodes[old].left), at(nodes[old].right) }); }
+    tree.top = order.empty() ? none : 0;
+    return tree;
+  }
+
+private:
+  // children are computed instead of loaded, and the loop has no branch to mispredict:
+  // k goes left or right by the comparison until it falls out of the tree
+  index find_implicit(const T &key) const
+  {
+    const std::size_t n = nodes.size();
+    std::size_t k = 1;
+    while (k <= n) {
+#if defined(__GNUC__) || defined(__clang__)
+      // the 16 nodes four levels down share a few cache lines
+      __builtin_prefetch(nodes.data() + std::min(16 * k, n) - 1);
+#endif
+      k = 2 * k + (nodes[k - 1].value < key);
+    }
+    // the right turns at the end led past the lower bound, the last left turn was at it
+    k >>= std::countr_one(k) + 1;
+    return k != 0 && !(key < nodes[k - 1].value) ? static_cast<index>(k - 1) : none;
+  }
+
+  // calls fun(i) for the subtree of `from` in pre-order
+  template<typename Fun> void for_each_pre_order(index from, Fun fun) const
+  {
+    std::vector<index> pending{ from };
+    while (!pending.empty()) {
+      index i = pending.back();
+      pending.pop_back();
+      fun(i);
+      if (nodes[i].right != none) { pending.push_back(nodes[i].right); }
+      if (nodes[i].left != none) { pending.push_back(nodes[i].left); }
+    }
+  }
+
+  // lays out the `levels` top levels of the subtree of `from`
+  void van_emde_boas(index from, std::size_t levels, std::vector<index> &order) const
+  {
+    if (levels == 1) {
+      order.push_back(from);
+      return;
+    }
+    const std::size_t upper = levels / 2;
+    van_emde_boas(from, upper, order);
+
+    // roots of the lower subtrees, left to right
+    std::vector<std::pair<index, std::size_t>> pending{ { from, 0 } };
+    std::vector<index> lower;
+    while (!pending.empty()) {
+      auto [i, depth] = pending.back();
+      pending.pop_back();
+      if (depth == upper) {
+        lower.push_back(i);
+        continue;
+      }
+      if (nodes[i].right != none) { pending.emplace_back(nodes[i].right, depth + 1); }
+      if (nodes[i].left != none) { pending.emplace_back(nodes[i].left, depth + 1); }
+    }
+    for (index i : lower) { van_emde_boas(i, levels - upper, order); }
+  }
+
+  std::vector<node> nodes;
+  index top = none;
+  bool implicit = false;// complete tree in breadth first order, made by from_sorted()
+};
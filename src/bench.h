@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+// tiny helpers shared by run_*_benchmarks() functions,
+// there is no benchmark library in the dependencies
+// so steady_clock is good enough for comparing implementations
+namespace bench {
+
+/// sizes used by benchmarks are skipped if they exceed this value
+/// (can be changed from the command line with --bench-limit)
+constexpr std::size_t kDefaultLimit = 10'000'000;
+
+/// prevents the optimizer from throwing away a computed value
+template<typename T> inline void keep(T const &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile T const *sink;
+  sink = &value;
+#endif
+}
+
+/// runs fun `repeats` times and returns the best wall time in milliseconds
+template<typename F> double measure_ms(F &&fun, int repeats = 3)
+{
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    fun();
+    std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+    best = std::min(best, took.count());
+  }
+  return best;
+}
+
+/// prints one line of a benchmark table
+inline void report(const std::string &name, std::size_t items, double ms)
+{
+  double ns_per_item = items ? ms * 1e6 / static_cast<double>(items) : 0.0;
+  std::cout << std::left << std::setw(40) << name << std::right << std::setw(12) << items << " items "
+            << std::fixed << std::setprecision(3) << std::setw(12) << ms << " ms " << std::setw(10) << ns_per_item
+            << " ns/item\n";
+}
+
+}// namespace bench
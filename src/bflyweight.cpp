@@ -1,12 +1,14 @@
 #include "bflyweight.h"
+#include "flyweight_policies.h"
+#include "name_table.h"
 
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 using namespace std;
 
-#include <boost/bimap.hpp>
 #include <boost/flyweight.hpp>
 #include <boost/flyweight/key_value.hpp>
 using namespace boost;
@@ -17,30 +19,28 @@ using namespace flyweights;
 // boost.flyweight
 
 // naive
-typedef uint32_t key;
+typedef NameTable::id key;
 
+namespace {
 // mmorpg
 struct User
 {
-  User(const string &first_name, const string &last_name)
+  User(string_view first_name, string_view last_name)
     : first_name{ add(first_name) }, last_name{ add(last_name) }
   {}
 
-  const string &get_first_name() const
-  {
-    return names.left.find(last_name)->second;
-  }
+  string_view get_first_name() const { return names[first_name]; }
 
-  const string &get_last_name() const
-  {
-    return names.left.find(last_name)->second;
-  }
+  string_view get_last_name() const { return names[last_name]; }
 
   static void info()
   {
-    for (auto entry : names.left) {
-      cout << "Key: " << entry.first << ", Value: " << entry.second << endl;
+    for (key id = 0; id < names.size(); ++id) {
+      cout << "Key: " << id << ", Value: " << names[id] << endl;
     }
+    auto stats = names.statistics();
+    cout << stats.unique << " unique of " << stats.interned << " names, " << stats.bytes_saved() << " bytes saved"
+         << endl;
   }
 
   friend ostream &operator<<(ostream &os, const User &obj)
@@ -50,25 +50,14 @@ struct User
   }
 
 protected:
-  static bimap<key, string> names;
-  static key seed;
+  static NameTable names;
 
-  static key add(const string &s)
-  {
-    auto it = names.right.find(s);
-    if (it == names.right.end()) {
-      // add it
-      key id = ++seed;
-      names.insert({ seed, s });
-      return id;
-    }
-    return it->second;
-  }
+  static key add(string_view s) { return names.intern(s); }
   key first_name, last_name;
 };
 
-key User::seed = 0;
-bimap<key, string> User::names{};
+NameTable User::names{};
+}// namespace
 
 void naive_flyweight()
 {
@@ -81,15 +70,6 @@ void naive_flyweight()
   User::info();
 }
 
-struct User2
-{
-  flyweight<string> first_name, last_name;
-
-  User2(const string &first_name, const string &last_name)
-    : first_name(first_name), last_name(last_name)
-  {}
-};
-
 void boost_flyweight()
 {
   User2 user1{ "John", "Smith" };
@@ -101,6 +81,13 @@ void boost_flyweight()
        << endl;
   cout << boolalpha << (&user1.last_name.get() == &user2.last_name.get())
        << endl;
+
+  // the same with other factories, each variant has its own values
+  ShardedUser2 sharded1{ "John", "Smith" };
+  ShardedUser2 sharded2{ "Jane", "Smith" };
+  ThreadLocalUser2 local{ "John", "Smith" };
+  cout << boolalpha << (&sharded1.last_name.get() == &sharded2.last_name.get()) << " "
+       << (&sharded1.last_name.get() == &local.last_name.get()) << endl;
 }
 
 void run_bflyweight_examples()
@@ -1,3 +1,6 @@
 #pragma once
 
-void run_bflyweight_examples();
\ No newline at end of file
+#include <cstddef>
+
+void run_bflyweight_examples();
+void run_bflyweight_benchmarks(std::size_t limit);
@@ -0,0 +1,171 @@
+#include "bench.h"
+#include "bflyweight.h"
+#include "flyweight_policies.h"
+#include "name_table.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <boost/bimap.hpp>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// names of the original User: a bimap, right.find() and then a separate insert
+struct BimapNames
+{
+  boost::bimap<std::uint32_t, std::string> names;
+  std::uint32_t seed = 0;
+
+  std::uint32_t add(const std::string &s)
+  {
+    auto it = names.right.find(s);
+    if (it == names.right.end()) {
+      std::uint32_t id = ++seed;
+      names.insert({ seed, s });
+      return id;
+    }
+    return it->second;
+  }
+
+  const std::string &get(std::uint32_t id) const { return names.left.find(id)->second; }
+};
+
+// first and last names of `count` users picked from smaller sets
+struct Users
+{
+  std::vector<std::string> first, last;
+
+  explicit Users(std::size_t count)
+  {
+    std::uint64_t state = 7;
+    auto next = [&state] {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return state >> 33;
+    };
+    first.reserve(count);
+    last.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      first.push_back("first_" + std::to_string(next() % 5'000));
+      last.push_back("last_name_" + std::to_string(next() % 50'000));
+    }
+  }
+};
+
+void bench_names(std::size_t count)
+{
+  std::cout << "--- " << count << " users, 5000 first and 50000 last names ---\n";
+  Users users{ count };
+  std::vector<std::uint32_t> ids(2 * count);
+
+  BimapNames bimap;
+  bench::report("bimap: create users", count, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      ids[2 * i] = bimap.add(users.first[i]);
+      ids[2 * i + 1] = bimap.add(users.last[i]);
+    }
+  }, 1));
+  bench::report("bimap: read names", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) { total += bimap.get(ids[2 * i]).size() + bimap.get(ids[2 * i + 1]).size(); }
+    bench::keep(total);
+  }));
+
+  std::vector<User2> flyweights;
+  flyweights.reserve(count);
+  bench::report("boost::flyweight: create users", count, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < count; ++i) { flyweights.emplace_back(users.first[i], users.last[i]); }
+  }, 1));
+  bench::report("boost::flyweight: read names", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (const auto &user : flyweights) { total += user.first_name.get().size() + user.last_name.get().size(); }
+    bench::keep(total);
+  }));
+  flyweights.clear();
+
+  NameTable table;
+  bench::report("NameTable: create users", count, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      ids[2 * i] = table.intern(users.first[i]);
+      ids[2 * i + 1] = table.intern(users.last[i]);
+    }
+  }, 1));
+  bench::report("NameTable: read names", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) { total += table[ids[2 * i]].size() + table[ids[2 * i + 1]].size(); }
+    bench::keep(total);
+  }));
+
+  NameTable bulk;
+  std::vector<std::string_view> batch;
+  batch.reserve(2 * count);
+  for (std::size_t i = 0; i < count; ++i) {
+    batch.push_back(users.first[i]);
+    batch.push_back(users.last[i]);
+  }
+  bench::report("NameTable: intern_bulk", count, bench::measure_ms([&] { bulk.intern_bulk(batch, ids); }, 1));
+
+  auto stats = bulk.statistics();
+  std::cout << "NameTable: " << stats.unique << " unique of " << stats.interned << " names, " << stats.bytes_saved()
+            << " bytes saved\n";
+}
+
+// every thread creates users and destroys them again (64 stay alive at a time);
+// each create + destroy is timed, the p99 comes from all of them
+template<typename User> void contention(const std::string &name, const Users &users, std::size_t threads, std::size_t ops)
+{
+  using clock = std::chrono::steady_clock;
+  constexpr std::size_t kAlive = 64;
+  std::vector<std::vector<std::uint32_t>> latencies(threads);
+
+  auto start = clock::now();
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      auto &lat = latencies[t];
+      lat.reserve(ops / threads);
+      std::deque<User> alive;
+      for (std::size_t i = t; i < ops; i += threads) {
+        auto begin = clock::now();
+        alive.emplace_back(users.first[i % users.first.size()], users.last[i % users.last.size()]);
+        if (alive.size() > kAlive) { alive.pop_front(); }
+        lat.push_back(static_cast<std::uint32_t>(std::chrono::nanoseconds{ clock::now() - begin }.count()));
+      }
+    });
+  }
+  for (auto &w : workers) { w.join(); }
+  std::chrono::duration<double, std::milli> took = clock::now() - start;
+
+  std::vector<std::uint32_t> all;
+  for (const auto &lat : latencies) { all.insert(all.end(), lat.begin(), lat.end()); }
+  auto p99 = all.begin() + static_cast<std::ptrdiff_t>(all.size() * 99 / 100);
+  std::nth_element(all.begin(), p99, all.end());
+
+  bench::report(name + " x" + std::to_string(threads), ops, took.count());
+  std::cout << "  " << static_cast<std::uint64_t>(static_cast<double>(ops) / took.count() * 1000.0)
+            << " users/s, p99 " << *p99 << " ns\n";
+}
+
+void bench_policies(std::size_t ops)
+{
+  std::cout << "--- create/destroy " << ops << " users, " << std::thread::hardware_concurrency() << " cores ---\n";
+  Users users{ 100'000 };
+  for (std::size_t threads : { 1U, 4U, 32U }) {
+    contention<User2>("refcounted, global lock", users, threads, ops);
+    contention<UntrackedUser2>("no tracking, global lock", users, threads, ops);
+    contention<ThreadLocalUser2>("thread local factory", users, threads, ops);
+    contention<ShardedUser2>("sharded factory", users, threads, ops);
+  }
+}
+
+}// namespace
+
+void run_bflyweight_benchmarks(std::size_t limit)
+{
+  bench_names(std::min<std::size_t>(limit, 1'000'000));
+  bench_policies(std::min<std::size_t>(limit, 2'000'000));
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "recursive_generator.h"
+#include "thread_pool.h"
+
+// Binary tree of heap nodes linked with pointers.
+// The tree owns its nodes and deletes them when it goes away.
+// Every node knows the size of its subtree, which lets parallel_for_each and
+// parallel_reduce decide what is worth a task and where every node is in
+// a traversal without walking the tree first.
+
+/// order of a traversal: a node before its subtrees, between them or after them
+enum class tree_order { pre_order, in_order, post_order };
+
+template<typename T> struct BinaryTree;
+
+template<typename T> struct Node
+{
+  T value;
+  Node<T> *left = nullptr;
+  Node<T> *right = nullptr;
+  Node<T> *parent = nullptr;
+  BinaryTree<T> *tree = nullptr;
+  std::size_t size = 1;// nodes in the subtree, set by set_tree
+
+  // constructors
+
+  explicit Node(const T &value) : value(value) {}
+
+  Node(const T &value, Node<T> *const left, Node<T> *const right)
+    : value(value), left(left), right(right)
+  {
+    if (left) { left->parent = this; }
+    if (right) { right->parent = this; }
+  }
+
+  // with a loop, so degenerated trees don't run out of stack;
+  // nodes are listed parents first, so sizes are summed up backwards
+  void set_tree(BinaryTree<T> *t)
+  {
+    std::vector<Node<T> *> nodes{ this };
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      Node<T> *node = nodes[i];
+      node->tree = t;
+      if (node->left) { nodes.push_back(node->left); }
+      if (node->right) { nodes.push_back(node->right); }
+    }
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      (*it)->size = 1 + ((*it)->left ? (*it)->left->size : 0) + ((*it)->right ? (*it)->right->size : 0);
+    }
+  }
+};
+
+// despite of the name it walks the tree in order: left subtree, node, right subtree
+template<typename U> struct PreOrderIterator
+{
+  Node<U> *current;
+
+  explicit PreOrderIterator(Node<U> *current) : current(current) {}
+
+  bool operator!=(const PreOrderIterator<U> &other)
+  {
+    return current != other.current;
+  }
+
+  Node<U> &operator*() { return *current; }
+
+  PreOrderIterator<U> &operator++()
+  {
+    if (current->right) {
+      current = current->right;
+      while (current->left) { current = current->left; }
+    } else {
+      Node<U> *p = current->parent;
+      while (p && current == p->right) {
+        current = p;
+        p = p->parent;
+      }
+      current = p;
+    }
+    return *this;
+  }
+};
+
+template<typename T> struct BinaryTree
+{
+  Node<T> *root = nullptr;
+
+  explicit BinaryTree(Node<T> *const root) : root(root)
+  {
+    if (root) { root->set_tree(this); }
+  }
+
+  BinaryTree(const BinaryTree &) = delete;
+  BinaryTree &operator=(const BinaryTree &) = delete;
+
+  ~BinaryTree()
+  {
+    std::vector<Node<T> *> pending;
+    if (root) { pending.push_back(root); }
+    while (!pending.empty()) {
+      Node<T> *node = pending.back();
+      pending.pop_back();
+      if (node->left) { pending.push_back(node->left); }
+      if (node->right) { pending.push_back(node->right); }
+      delete node;
+    }
+  }
+
+  typedef PreOrderIterator<T> iterator;
+
+  iterator begin()
+  {
+    Node<T> *n = root;
+
+    if (n) {
+      while (n->left) { n = n->left; }
+    }
+    return iterator{ n };
+  }
+
+  iterator end() { return iterator{ nullptr }; }
+
+  class pre_order_traversal
+  {
+    BinaryTree<T> &tree;
+
+  public:
+    pre_order_traversal(BinaryTree<T> &tree) : tree{ tree } {}
+    iterator begin() { return tree.begin(); }
+    iterator end() { return tree.end(); }
+  } pre_order { *this };
+
+  recursive_generator<Node<T> *> post_order()
+  {
+    return post_order_impl(root);
+  }
+
+  /// subtrees bigger than this go to the pool as tasks
+  static constexpr std::size_t kParallelCutoff = 2048;
+
+  /// calls fun(node, position) for every node, where position is the place of
+  /// the node in the sequential traversal; a node is visited before its subtrees
+  /// in pre_order and after them in post_order, in_order only gives positions.
+  /// fun is called from several threads at once
+  template<typename Fun>
+  void parallel_for_each(tree_order order, Fun fun, ThreadPool &pool = ThreadPool::shared(),
+    std::size_t cutoff = kParallelCutoff)
+  {
+    for_each_from(root, 0, order, fun, pool, cutoff);
+  }
+
+  /// the same as folding map(node) of every node in `order` with combine, which
+  /// has to be associative but doesn't have to be commutative; map and combine
+  /// are called from several threads at once
+  template<typename R, typename Map, typename Combine>
+  R parallel_reduce(tree_order order, R identity, Map map, Combine combine, ThreadPool &pool = ThreadPool::shared(),
+    std::size_t cutoff = kParallelCutoff)
+  {
+    return reduce_from(root, order, identity, map, combine, pool, cutoff);
+  }
+
+  private:
+    static std::size_t size_of(const Node<T> *node) { return node ? node->size : 0; }
+
+    struct Places
+    {
+      std::size_t self, left, right;
+    };
+
+    // positions of a node and of its subtrees, when its subtree starts at base
+    static Places places(tree_order order, const Node<T> *node, std::size_t base)
+    {
+      auto left = size_of(node->left);
+      switch (order) {
+      case tree_order::pre_order: return { base, base + 1, base + 1 + left };
+      case tree_order::in_order: return { base + left, base, base + left + 1 };
+      case tree_order::post_order: return { base + left + size_of(node->right), base, base + left };
+      }
+      return {};
+    }
+
+    // A big subtree is walked down along its bigger children, the other child
+    // goes to the pool if it is big too. The way down is a loop, so a deep
+    // tree doesn't use up the stack; only subtrees under the cutoff are recursive.
+
+    template<typename Fun>
+    static void for_each_from(Node<T> *node, std::size_t base, tree_order order, Fun &fun, ThreadPool &pool,
+      std::size_t cutoff)
+    {
+      std::vector<std::pair<Node<T> *, std::size_t>> after;// post_order nodes waiting for their subtrees
+      TaskGroup group{ pool };
+      while (node && node->size > cutoff) {
+        auto at = places(order, node, base);
+        bool go_left = size_of(node->left) >= size_of(node->right);
+        Node<T> *other = go_left ? node->right : node->left;
+        std::size_t other_base = go_left ? at.right : at.left;
+
+        if (order == tree_order::post_order) {
+          after.emplace_back(node, at.self);
+        } else {
+          fun(*node, at.self);
+        }
+        if (size_of(other) > cutoff) {
+          group.run([other, other_base, order, &fun, &pool, cutoff] {
+            for_each_from(other, other_base, order, fun, pool, cutoff);
+          });
+        } else {
+          for_each_small(other, other_base, order, fun);
+        }
+        base = go_left ? at.left : at.right;
+        node = go_left ? node->left : node->right;
+      }
+      for_each_small(node, base, order, fun);
+      group.wait();
+      for (auto it = after.rbegin(); it != after.rend(); ++it) { fun(*it->first, it->second); }
+    }
+
+    template<typename Fun> static void for_each_small(Node<T> *node, std::size_t base, tree_order order, Fun &fun)
+    {
+      if (!node) { return; }
+      auto at = places(order, node, base);
+      if (order == tree_order::pre_order) { fun(*node, at.self); }
+      for_each_small(node->left, at.left, order, fun);
+      if (order == tree_order::in_order) { fun(*node, at.self); }
+      for_each_small(node->right, at.right, order, fun);
+      if (order == tree_order::post_order) { fun(*node, at.self); }
+    }
+
+    template<typename R, typename Combine>
+    static R combine_in(tree_order order, Combine &combine, R self, R left, R right)
+    {
+      switch (order) {
+      case tree_order::pre_order: return combine(combine(std::move(self), std::move(left)), std::move(right));
+      case tree_order::in_order: return combine(combine(std::move(left), std::move(self)), std::move(right));
+      case tree_order::post_order: break;
+      }
+      return combine(combine(std::move(left), std::move(right)), std::move(self));
+    }
+
+    template<typename R, typename Map, typename Combine>
+    static R reduce_from(Node<T> *node, tree_order order, const R &identity, Map &map, Combine &combine,
+      ThreadPool &pool, std::size_t cutoff)
+    {
+      struct Step
+      {
+        Node<T> *node;
+        bool went_left;
+        R other;// result of the child which wasn't walked down
+      };
+      std::deque<Step> steps;// a deque keeps the results in place for the tasks writing them
+      TaskGroup group{ pool };
+      while (node && node->size > cutoff) {
+        bool go_left = size_of(node->left) >= size_of(node->right);
+        Node<T> *other = go_left ? node->right : node->left;
+        auto &step = steps.emplace_back(Step{ node, go_left, identity });
+        if (size_of(other) > cutoff) {
+          group.run([other, order, &identity, &map, &combine, &pool, cutoff, &result = step.other] {
+            result = reduce_from(other, order, identity, map, combine, pool, cutoff);
+          });
+        } else {
+          step.other = reduce_small(other, order, identity, map, combine);
+        }
+        node = go_left ? node->left : node->right;
+      }
+      R result = reduce_small(node, order, identity, map, combine);
+      group.wait();
+      for (auto it = steps.rbegin(); it != steps.rend(); ++it) {
+        R self = map(*it->node);
+        result = it->went_left ? combine_in(order, combine, std::move(self), std::move(result), std::move(it->other))
+                               : combine_in(order, combine, std::move(self), std::move(it->other), std::move(result));
+      }
+      return result;
+    }
+
+    template<typename R, typename Map, typename Combine>
+    static R reduce_small(Node<T> *node, tree_order order, const R &identity, Map &map, Combine &combine)
+    {
+      if (!node) { return identity; }
+      return combine_in(order, combine, R(map(*node)), reduce_small(node->left, order, identity, map, combine),
+        reduce_small(node->right, order, identity, map, combine));
+    }
+
+    // subtrees are delegated to, not re-yielded, so a value reaches the
+    // consumer in one resume however deep it is
+    recursive_generator<Node<T> *> post_order_impl(Node<T> *node)
+    {
+      if (node) {
+        if (node->left) { co_yield post_order_impl(node->left); }
+        if (node->right) { co_yield post_order_impl(node->right); }
+        co_yield node;
+      }
+    }
+};
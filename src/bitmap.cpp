@@ -0,0 +1,260 @@
+#include "bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+using Container = Bitmap::Container;
+
+namespace {
+
+std::uint16_t high_of(std::uint32_t id) { return static_cast<std::uint16_t>(id >> 16); }
+std::uint16_t low_of(std::uint32_t id) { return static_cast<std::uint16_t>(id & 0xFFFF); }
+
+std::uint32_t popcount(const std::vector<std::uint64_t> &bits)
+{
+  std::uint32_t card = 0;
+  for (auto word : bits) { card += static_cast<std::uint32_t>(std::popcount(word)); }
+  return card;
+}
+
+Container intersect(const Container &lhs, const Container &rhs)
+{
+  Container out;
+  out.key = lhs.key;
+  if (lhs.dense() && rhs.dense()) {
+    out.bits.resize(Bitmap::kWords);
+    for (std::size_t w = 0; w < Bitmap::kWords; ++w) { out.bits[w] = lhs.bits[w] & rhs.bits[w]; }
+    out.card = popcount(out.bits);
+  } else if (!lhs.dense() && !rhs.dense()) {
+    std::set_intersection(
+      lhs.values.begin(), lhs.values.end(), rhs.values.begin(), rhs.values.end(), std::back_inserter(out.values));
+    out.card = static_cast<std::uint32_t>(out.values.size());
+  } else {
+    const auto &sparse = lhs.dense() ? rhs : lhs;
+    const auto &dense = lhs.dense() ? lhs : rhs;
+    for (auto low : sparse.values) {
+      if (dense.contains(low)) { out.values.push_back(low); }
+    }
+    out.card = static_cast<std::uint32_t>(out.values.size());
+  }
+  out.normalize();
+  return out;
+}
+
+Container unite(const Container &lhs, const Container &rhs)
+{
+  Container out;
+  out.key = lhs.key;
+  if (!lhs.dense() && !rhs.dense()) {
+    std::set_union(
+      lhs.values.begin(), lhs.values.end(), rhs.values.begin(), rhs.values.end(), std::back_inserter(out.values));
+    out.card = static_cast<std::uint32_t>(out.values.size());
+  } else {
+    out = lhs.dense() ? lhs : rhs;
+    const auto &other = lhs.dense() ? rhs : lhs;
+    if (other.dense()) {
+      for (std::size_t w = 0; w < Bitmap::kWords; ++w) { out.bits[w] |= other.bits[w]; }
+    } else {
+      for (auto low : other.values) { out.bits[low / 64] |= std::uint64_t{ 1 } << (low % 64); }
+    }
+    out.card = popcount(out.bits);
+  }
+  out.normalize();
+  return out;
+}
+
+Container subtract(const Container &lhs, const Container &rhs)
+{
+  Container out;
+  out.key = lhs.key;
+  if (!lhs.dense()) {
+    for (auto low : lhs.values) {
+      if (!rhs.contains(low)) { out.values.push_back(low); }
+    }
+    out.card = static_cast<std::uint32_t>(out.values.size());
+  } else {
+    out.bits = lhs.bits;
+    if (rhs.dense()) {
+      for (std::size_t w = 0; w < Bitmap::kWords; ++w) { out.bits[w] &= ~rhs.bits[w]; }
+    } else {
+      for (auto low : rhs.values) { out.bits[low / 64] &= ~(std::uint64_t{ 1 } << (low % 64)); }
+    }
+    out.card = popcount(out.bits);
+  }
+  out.normalize();
+  return out;
+}
+
+}// namespace
+
+bool Container::contains(std::uint16_t low) const
+{
+  if (dense()) { return (bits[low / 64] >> (low % 64)) & 1U; }
+  return std::binary_search(values.begin(), values.end(), low);
+}
+
+void Container::to_dense()
+{
+  bits.assign(Bitmap::kWords, 0);
+  for (auto low : values) { bits[low / 64] |= std::uint64_t{ 1 } << (low % 64); }
+  values = {};
+}
+
+void Container::to_sparse()
+{
+  values.clear();
+  values.reserve(card);
+  for (std::size_t w = 0; w < bits.size(); ++w) {
+    for (std::uint64_t word = bits[w]; word != 0; word &= word - 1) {
+      values.push_back(static_cast<std::uint16_t>(w * 64 + static_cast<std::size_t>(std::countr_zero(word))));
+    }
+  }
+  bits = {};
+}
+
+void Container::normalize()
+{
+  if (dense() && card < Bitmap::kMinDense) {
+    to_sparse();
+  } else if (!dense() && card > Bitmap::kMaxArray) {
+    to_dense();
+  }
+}
+
+Container *Bitmap::find(std::uint16_t key)
+{
+  auto it = std::lower_bound(
+    containers.begin(), containers.end(), key, [](const Container &cnt, std::uint16_t k) { return cnt.key < k; });
+  return it != containers.end() && it->key == key ? &*it : nullptr;
+}
+
+const Container *Bitmap::find(std::uint16_t key) const { return const_cast<Bitmap *>(this)->find(key); }
+
+void Bitmap::add(std::uint32_t id)
+{
+  auto key = high_of(id);
+  auto low = low_of(id);
+  auto it = std::lower_bound(
+    containers.begin(), containers.end(), key, [](const Container &cnt, std::uint16_t k) { return cnt.key < k; });
+  if (it == containers.end() || it->key != key) {
+    it = containers.insert(it, Container{});
+    it->key = key;
+  }
+
+  if (it->dense()) {
+    auto &word = it->bits[low / 64];
+    auto mask = std::uint64_t{ 1 } << (low % 64);
+    if ((word & mask) == 0) {
+      word |= mask;
+      ++it->card;
+    }
+    return;
+  }
+  auto pos = std::lower_bound(it->values.begin(), it->values.end(), low);
+  if (pos != it->values.end() && *pos == low) { return; }
+  it->values.insert(pos, low);
+  ++it->card;
+  it->normalize();
+}
+
+void Bitmap::remove(std::uint32_t id)
+{
+  auto *cnt = find(high_of(id));
+  if (!cnt) { return; }
+
+  auto low = low_of(id);
+  if (cnt->dense()) {
+    auto &word = cnt->bits[low / 64];
+    auto mask = std::uint64_t{ 1 } << (low % 64);
+    if ((word & mask) == 0) { return; }
+    word &= ~mask;
+  } else {
+    auto pos = std::lower_bound(cnt->values.begin(), cnt->values.end(), low);
+    if (pos == cnt->values.end() || *pos != low) { return; }
+    cnt->values.erase(pos);
+  }
+  --cnt->card;
+
+  if (cnt->card == 0) {
+    containers.erase(containers.begin() + (cnt - containers.data()));
+  } else {
+    cnt->normalize();
+  }
+}
+
+bool Bitmap::contains(std::uint32_t id) const
+{
+  const auto *cnt = find(high_of(id));
+  return cnt && cnt->contains(low_of(id));
+}
+
+std::size_t Bitmap::cardinality() const
+{
+  std::size_t card = 0;
+  for (const auto &cnt : containers) { card += cnt.card; }
+  return card;
+}
+
+std::size_t Bitmap::dense_containers() const
+{
+  return static_cast<std::size_t>(std::count_if(containers.begin(), containers.end(), [](const Container &cnt) {
+    return cnt.dense();
+  }));
+}
+
+std::vector<std::uint32_t> Bitmap::to_vector() const
+{
+  std::vector<std::uint32_t> ids;
+  ids.reserve(cardinality());
+  for_each([&ids](std::uint32_t id) { ids.push_back(id); });
+  return ids;
+}
+
+Bitmap operator&(const Bitmap &lhs, const Bitmap &rhs)
+{
+  Bitmap out;
+  auto l = lhs.containers.begin();
+  auto r = rhs.containers.begin();
+  while (l != lhs.containers.end() && r != rhs.containers.end()) {
+    if (l->key < r->key) {
+      ++l;
+    } else if (r->key < l->key) {
+      ++r;
+    } else {
+      auto cnt = intersect(*l++, *r++);
+      if (cnt.card) { out.containers.push_back(std::move(cnt)); }
+    }
+  }
+  return out;
+}
+
+Bitmap operator|(const Bitmap &lhs, const Bitmap &rhs)
+{
+  Bitmap out;
+  auto l = lhs.containers.begin();
+  auto r = rhs.containers.begin();
+  while (l != lhs.containers.end() || r != rhs.containers.end()) {
+    if (r == rhs.containers.end() || (l != lhs.containers.end() && l->key < r->key)) {
+      out.containers.push_back(*l++);
+    } else if (l == lhs.containers.end() || r->key < l->key) {
+      out.containers.push_back(*r++);
+    } else {
+      out.containers.push_back(unite(*l++, *r++));
+    }
+  }
+  return out;
+}
+
+Bitmap and_not(const Bitmap &lhs, const Bitmap &rhs)
+{
+  Bitmap out;
+  for (const auto &cnt : lhs.containers) {
+    const auto *other = rhs.find(cnt.key);
+    if (!other) {
+      out.containers.push_back(cnt);
+      continue;
+    }
+    auto rest = subtract(cnt, *other);
+    if (rest.card) { out.containers.push_back(std::move(rest)); }
+  }
+  return out;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed bitmap of 32-bit ids, organized like a roaring bitmap:
+// ids are grouped by their upper 16 bits into containers, a container keeps
+// the lower 16 bits either as a sorted array (sparse, up to 4096 values)
+// or as a plain 65536-bit set (dense). Set operations are done container
+// by container and pick the cheapest algorithm for the pair of kinds.
+// A dense container turns back into an array only when it shrinks below
+// kMinDense, so ids added and removed around kMaxArray don't make it
+// convert back and forth on every call.
+
+class Bitmap
+{
+public:
+  void add(std::uint32_t id);
+  void remove(std::uint32_t id);
+  [[nodiscard]] bool contains(std::uint32_t id) const;
+
+  [[nodiscard]] std::size_t cardinality() const;
+  [[nodiscard]] bool empty() const { return containers.empty(); }
+  /// number of containers kept as bit sets
+  [[nodiscard]] std::size_t dense_containers() const;
+
+  /// all ids in ascending order
+  [[nodiscard]] std::vector<std::uint32_t> to_vector() const;
+
+  template<typename F> void for_each(F &&fun) const
+  {
+    for (const auto &cnt : containers) {
+      std::uint32_t high = static_cast<std::uint32_t>(cnt.key) << 16;
+      if (cnt.dense()) {
+        for (std::size_t w = 0; w < cnt.bits.size(); ++w) {
+          for (std::uint64_t word = cnt.bits[w]; word != 0; word &= word - 1) {
+            fun(high | static_cast<std::uint32_t>(w * 64 + static_cast<std::size_t>(std::countr_zero(word))));
+          }
+        }
+      } else {
+        for (auto low : cnt.values) { fun(high | low); }
+      }
+    }
+  }
+
+  friend Bitmap operator&(const Bitmap &lhs, const Bitmap &rhs);
+  friend Bitmap operator|(const Bitmap &lhs, const Bitmap &rhs);
+  /// ids of lhs which are not in rhs
+  friend Bitmap and_not(const Bitmap &lhs, const Bitmap &rhs);
+
+  friend bool operator==(const Bitmap &lhs, const Bitmap &rhs) { return lhs.to_vector() == rhs.to_vector(); }
+
+  static constexpr std::size_t kMaxArray = 4096;
+  static constexpr std::size_t kMinDense = kMaxArray / 2;
+  static constexpr std::size_t kWords = 65536 / 64;
+
+  struct Container
+  {
+    std::uint16_t key = 0;
+    std::uint32_t card = 0;
+    // exactly one of them is in use
+    std::vector<std::uint16_t> values;// sorted
+    std::vector<std::uint64_t> bits;// kWords words
+
+    [[nodiscard]] bool dense() const { return !bits.empty(); }
+    [[nodiscard]] bool contains(std::uint16_t low) const;
+    void to_dense();
+    void to_sparse();
+    /// turns the container into the representation which suits its cardinality
+    void normalize();
+  };
+
+private:
+  Container *find(std::uint16_t key);
+  [[nodiscard]] const Container *find(std::uint16_t key) const;
+
+  std::vector<Container> containers;// sorted by key, never empty
+};
@@ -1,28 +1,152 @@
 #include "person.h"
 #include "chatroom.h"
+#include "thread_pool.h"
 #include <algorithm>
 
+namespace {
+ChatLine make_line(const string &origin, const string &message)
+{
+  return std::make_shared<const string>(origin + ": \"" + message + "\"");
+}
+}// namespace
+
 void ChatRoom::broadcast(const string &origin, const string &message)
 {
-  for (auto p : people)
-    if (p->name != origin) p->receive(origin, message);
+  StringInterner::id from = kNobody;
+  if (!names->find(origin, from)) { from = kNobody; }
+  deliver(make_line(origin, message), from);
+}
+
+void ChatRoom::deliver(const ChatLine &line, StringInterner::id except)
+{
+  auto send = [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      if (name_ids[i] != except) { people[i]->receive(line); }
+    }
+  };
+  if (people.size() <= kParallelCutoff) {
+    send(0, people.size());
+    return;
+  }
+  // every member is in one chunk only, so receive() of a person is never called concurrently
+  TaskGroup group;
+  for (std::size_t first = 0; first < people.size(); first += kParallelCutoff) {
+    group.run([&send, first, last = std::min(people.size(), first + kParallelCutoff)] { send(first, last); });
+  }
+  group.wait();
 }
 
 void ChatRoom::join(Person *p)
 {
+  if (p->room == this) { return; }
   string join_msg = p->name + " joins the chat";
   broadcast("room", join_msg);
+  add(p);
+}
 
+void ChatRoom::join(std::span<Person *const> newcomers)
+{
+  auto count = std::count_if(newcomers.begin(), newcomers.end(), [this](const Person *p) { return p->room != this; });
+  if (count == 0) { return; }
+  broadcast("room", std::to_string(count) + " people join the chat");
+  auto size = people.size() + newcomers.size();
+  people.reserve(size);
+  name_ids.reserve(size);
+  next_same.reserve(size);
+  prev_same.reserve(size);
+  for (auto *p : newcomers) { add(p); }
+}
+
+void ChatRoom::add(Person *p)
+{
+  if (p->room == this) { return; }
+  // a person is in one room at a time
+  if (p->room) { p->room->leave(p); }
   p->room = this;
+  p->room_index = people.size();
   people.push_back(p);
+  name_ids.push_back(names->intern(p->name));
+  next_same.push_back(kNobody);
+  prev_same.push_back(kNobody);
+  hold(name_ids.back(), p->room_index);
+}
+
+void ChatRoom::hold(StringInterner::id id, std::size_t index)
+{
+  if (id >= by_name.size()) { by_name.resize(std::max<std::size_t>(id + 1, by_name.size() * 2), kNobody); }
+  auto head = by_name[id];
+  if (head == kNobody) {
+    ++held_names;
+  } else {
+    prev_same[head] = static_cast<std::uint32_t>(index);
+  }
+  next_same[index] = head;
+  prev_same[index] = kNobody;
+  by_name[id] = static_cast<std::uint32_t>(index);
+}
+
+void ChatRoom::unlink(std::size_t index)
+{
+  auto id = name_ids[index];
+  auto next = next_same[index];
+  auto prev = prev_same[index];
+  if (prev == kNobody) {
+    by_name[id] = next;
+  } else {
+    next_same[prev] = next;
+  }
+  if (next != kNobody) { prev_same[next] = prev; }
+  if (by_name[id] == kNobody) { --held_names; }
+}
+
+void ChatRoom::leave(Person *p)
+{
+  if (p->room != this) { return; }
+  auto index = p->room_index;
+  unlink(index);
+
+  // the last member takes the place of the one leaving, its neighbours in the list of its name follow
+  auto last = people.size() - 1;
+  if (index != last) {
+    people[index] = people[last];
+    name_ids[index] = name_ids[last];
+    next_same[index] = next_same[last];
+    prev_same[index] = prev_same[last];
+    people[index]->room_index = index;
+    auto moved = static_cast<std::uint32_t>(index);
+    if (prev_same[index] == kNobody) {
+      by_name[name_ids[index]] = moved;
+    } else {
+      next_same[prev_same[index]] = moved;
+    }
+    if (next_same[index] != kNobody) { prev_same[next_same[index]] = moved; }
+  }
+  people.pop_back();
+  name_ids.pop_back();
+  next_same.pop_back();
+  prev_same.pop_back();
+  p->room = nullptr;
+
+  if (names->size() > kKeptNames && names->size() > 2 * held_names) { forget_names(); }
+}
+
+void ChatRoom::forget_names()
+{
+  names = std::make_unique<StringInterner>(16);
+  by_name.clear();
+  held_names = 0;
+  for (std::size_t i = 0; i < people.size(); ++i) {
+    name_ids[i] = names->intern(people[i]->name);
+    hold(name_ids[i], i);
+  }
 }
 
 void ChatRoom::message(const string &origin,
   const string &who,
   const string &message)
 {
-  auto target = find_if(begin(people), end(people), [&](const Person *p) {
-    return p->name == who;
-  });
-  if (target != end(people)) { (*target)->receive(origin, message); }
-}
\ No newline at end of file
+  StringInterner::id target = 0;
+  if (names->find(who, target) && target < by_name.size() && by_name[target] != kNobody) {
+    people[by_name[target]]->receive(make_line(origin, message));
+  }
+}
@@ -1,17 +1,65 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "string_interner.h"
+
 struct Person;
 
+/// a message as it is shown, `origin: "text"`; one is made for a broadcast
+/// and shared by everyone who receives it
+using ChatLine = std::shared_ptr<const std::string>;
+
+// Members are kept in a dense array, so leaving is a swap with the last one,
+// and found by their interned names, so a private message is one lookup
+// instead of a search. A private message to a name several members have
+// goes to the one who joined last; the others are linked to it, so leaving
+// never searches either. Names nobody in the room has any more are dropped
+// once they are the majority of the interned ones.
 struct ChatRoom
 {
-  std::vector<Person *> people;// assume append-only
+  /// broadcasts to more members than this are split between the threads of the shared pool
+  static constexpr std::size_t kParallelCutoff = 64 * 1024;
 
   void join(Person *p);
+  /// joins them all with one announcement
+  void join(std::span<Person *const> newcomers);
+  void leave(Person *p);
+
   void broadcast(const std::string &origin, const std::string &message);
   void message(const std::string &origin,
     const std::string &who,
     const std::string &message);
-};
\ No newline at end of file
+
+  [[nodiscard]] std::size_t size() const { return people.size(); }
+  /// names interned so far, those of the members and some of the people who left
+  [[nodiscard]] std::size_t known_names() const { return names->size(); }
+
+private:
+  static constexpr std::uint32_t kNobody = UINT32_MAX;
+  // fewer names are never dropped
+  static constexpr std::size_t kKeptNames = 1024;
+
+  void add(Person *p);
+  /// member `index` has name `id`, it goes first in the list of holders of the name
+  void hold(StringInterner::id id, std::size_t index);
+  /// takes member `index` out of the list of holders of its name
+  void unlink(std::size_t index);
+  /// interns the names of the members again, forgetting the others
+  void forget_names();
+  void deliver(const ChatLine &line, StringInterner::id except);
+
+  std::unique_ptr<StringInterner> names = std::make_unique<StringInterner>(16);
+  std::vector<Person *> people;
+  std::vector<StringInterner::id> name_ids;// of people[i]
+  std::vector<std::uint32_t> by_name;// name id -> first member with it, kNobody if none
+  // of people[i]: the members with the same name form a list, kNobody at its ends
+  std::vector<std::uint32_t> next_same;
+  std::vector<std::uint32_t> prev_same;
+  std::size_t held_names = 0;// ids with holders
+};
@@ -1,36 +1,14 @@
 #include "composite.h"
+#include "expression.h"
+#include "expression_dag.h"
+#include "graphics.h"
+#include "scene.h"
 #include <iostream>
 #include <memory>
 #include <vector>
 
 using namespace std;
 
-struct GraphicObject
-{
-  virtual ~GraphicObject() = default;
-  virtual void draw() = 0;
-};
-
-struct Circle : GraphicObject
-{
-  void draw() override { std::cout << "Circle" << std::endl; }
-};
-
-struct Group : GraphicObject
-{
-  std::string name;
-
-  explicit Group(const std::string &name) : name{ name } {}
-
-  void draw() override
-  {
-    std::cout << "Group " << name.c_str() << " contains:" << std::endl;
-    for (auto &&o : objects) o->draw();
-  }
-
-  std::vector<GraphicObject *> objects;
-};
-
 inline void graphics()
 {
   Group root("root");
@@ -45,45 +23,23 @@ inline void graphics()
   root.draw();
 }
 
-// acuumulators
-// 2 + (3+4)
-struct Expression
-{
-  virtual double eval() = 0;
-  virtual void collect(vector<double> &v) = 0;
-};
-
-struct Literal : Expression
+inline void retained_graphics()
 {
-  double value;
-
-  explicit Literal(const double value) : value{ value } {}
-
-  double eval() override { return value; }
-
-  void collect(vector<double> &v) override { v.push_back(value); }
-};
-
-struct AdditionExpression : Expression
-{
-  shared_ptr<Expression> left, right;
-
-  AdditionExpression(const shared_ptr<Expression> &expression, const shared_ptr<Expression> &expression1)
-    : left{ expression }, right{ expression1 }
-  {}
-
-  double eval() override { return left->eval() + right->eval(); }
-
-  void collect(vector<double> &v) override
-  {
-    left->collect(v);
-    right->collect(v);
-  }
-};
+  Scene scene;
+  scene.add_circle(1, scene.root());
+  auto sub = scene.add_group("sub", scene.root());
+  auto circle = scene.add_circle(2, sub);
+
+  cout << scene.draw();
+  // only "sub" and the root are re-emitted
+  scene.set_radius(circle, 3);
+  cout << scene.draw();
+}
 
 void run_composite_examples()
 {
   graphics();
+  retained_graphics();
   AdditionExpression sum{ make_shared<Literal>(2),
     make_shared<AdditionExpression>(make_shared<Literal>(3), make_shared<Literal>(4)) };
   cout << "2+(3+4) = " << sum.eval() << endl;
@@ -93,6 +49,19 @@ void run_composite_examples()
   for (auto x : v) cout << x << "\t";
   cout << endl;
 
+  // the same tree as flat bytecode, literals can be rebound
+  auto program = ExpressionProgram::compile(sum);
+  cout << "compiled 2+(3+4) = " << program.run() << endl;
+  cout << "compiled 10+(20+30) = " << program.run(vector<double>{ 10, 20, 30 }) << endl;
+
+  // (a+b) + (b+a): both sums are one node, a change of b updates two nodes
+  ExpressionDag dag;
+  auto a = dag.input(1), b = dag.input(2);
+  auto total = dag.add(dag.add(a, b), dag.add(b, a));
+  cout << "(1+2)+(2+1) = " << dag.value(total) << " with " << dag.size() << " nodes" << endl;
+  dag.set(b, 5);
+  cout << "(1+5)+(5+1) = " << dag.value(total) << ", recomputed " << dag.recomputed() << " nodes" << endl;
+
   vector<double> values{ 1, 2, 3, 4 };
   double s = 0;
   for (auto x : values) s += x;
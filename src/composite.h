@@ -1,4 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 // composite is like a proxy too
 void run_composite_examples();
+void run_composite_benchmarks(std::size_t limit);
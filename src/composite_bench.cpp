@@ -0,0 +1,173 @@
+#include "bench.h"
+#include "composite.h"
+#include "expression.h"
+#include "expression_dag.h"
+#include "graphics.h"
+#include "scene.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// balanced sum of `leaves` literals (2 * leaves - 1 nodes)
+std::shared_ptr<Expression> make_sum(std::size_t first, std::size_t leaves)
+{
+  if (leaves == 1) { return std::make_shared<Literal>(static_cast<double>(first % 100)); }
+  auto half = leaves / 2;
+  return std::make_shared<AdditionExpression>(make_sum(first, half), make_sum(first + half, leaves - half));
+}
+
+void bench_expression(std::size_t nodes)
+{
+  std::cout << "--- expression of " << nodes << " nodes ---\n";
+  auto tree = make_sum(0, (nodes + 1) / 2);
+
+  bench::report("recursive eval()", nodes, bench::measure_ms([&] { bench::keep(tree->eval()); }));
+
+  ExpressionProgram program;
+  bench::report(
+    "compile to bytecode", nodes, bench::measure_ms([&] { program = ExpressionProgram::compile(*tree); }, 1));
+  bench::report("bytecode run()", nodes, bench::measure_ms([&] { bench::keep(program.run()); }));
+
+  // items are node evaluations here: nodes x sets
+  constexpr std::size_t kSets = 64;
+  std::vector<double> bindings(program.literals.size() * kSets, 1.0);
+  std::vector<double> out(kSets);
+  bench::report("bytecode run_batch() x64 sets", nodes * kSets, bench::measure_ms([&] {
+    program.run_batch(bindings, out);
+    bench::keep(out.front());
+  }));
+}
+
+// a tree of inputs whose sums share common subexpressions, one input changes per update
+void bench_dag(std::size_t nodes)
+{
+  std::cout << "--- expression DAG of " << nodes << " nodes, one input changes ---\n";
+  constexpr std::size_t kUpdates = 10'000;
+
+  std::vector<std::shared_ptr<Literal>> leaves;
+  std::vector<std::shared_ptr<Expression>> level;
+  for (std::size_t i = 0; i < (nodes + 1) / 2; ++i) {
+    leaves.push_back(std::make_shared<Literal>(1.0));
+    level.push_back(leaves.back());
+  }
+  while (level.size() > 1) {
+    std::vector<std::shared_ptr<Expression>> next;
+    for (std::size_t i = 0; i + 1 < level.size(); i += 2) {
+      next.push_back(std::make_shared<AdditionExpression>(level[i], level[i + 1]));
+    }
+    if (level.size() % 2) { next.push_back(level.back()); }
+    level = std::move(next);
+  }
+  auto tree = level.front();
+
+  std::mt19937 gen{ 11 };
+  std::uniform_int_distribution<std::size_t> pick(0, leaves.size() - 1);
+  double value = 1.0;
+
+  bench::report("tree: set value + eval()", kUpdates / 100, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < kUpdates / 100; ++i) {
+      leaves[pick(gen)]->value = ++value;
+      bench::keep(tree->eval());
+    }
+  }));
+
+  ExpressionDag dag;
+  std::vector<ExpressionDag::id> inputs;
+  ExpressionDag::id root = 0;
+  bench::report("DAG import", nodes, bench::measure_ms([&] { root = dag.import(*tree, &inputs); }, 1));
+  bench::report("DAG set() + value()", kUpdates, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < kUpdates; ++i) {
+      dag.set(inputs[pick(gen)], ++value);
+      bench::keep(dag.value(root));
+    }
+  }));
+  std::cout << dag.recomputed() << " nodes recomputed per update\n";
+
+  // the same tree built from copies: hash-consing stores each distinct sum once
+  auto copies = make_sum(0, (nodes + 1) / 2);
+  ExpressionDag shared;
+  bench::report("DAG import, literals as constants", nodes, bench::measure_ms([&] { shared.import(*copies); }, 1));
+  std::cout << nodes << " tree nodes became " << shared.size() << " DAG nodes\n";
+}
+
+// root -> groups -> subgroups -> circles, 100 children on every level
+void bench_scene(std::size_t circles)
+{
+  constexpr std::size_t kFanOut = 100;
+  std::cout << "--- scene of " << circles << " circles, 1% change per frame, " << ThreadPool::shared().size()
+            << " threads ---\n";
+
+  // immediate mode: every object is drawn on every frame
+  std::vector<Circle> shapes(circles);
+  std::vector<std::unique_ptr<Group>> owned;
+  Group root{ "root" };
+  for (std::size_t i = 0; i < circles; ++i) {
+    if (i % (kFanOut * kFanOut) == 0) {
+      owned.push_back(std::make_unique<Group>("g" + std::to_string(i)));
+      root.objects.push_back(owned.back().get());
+    }
+    if (i % kFanOut == 0) {
+      auto *parent = owned.back().get();
+      owned.push_back(std::make_unique<Group>("s" + std::to_string(i)));
+      parent->objects.push_back(owned.back().get());
+    }
+    owned.back()->objects.push_back(&shapes[i]);
+  }
+
+  bench::report("Group::draw() frame", circles, bench::measure_ms([&] {
+    std::ostringstream out;
+    auto *old = std::cout.rdbuf(out.rdbuf());
+    root.draw();
+    std::cout.rdbuf(old);
+    bench::keep(out.str().size());
+  }));
+
+  Scene scene;
+  std::vector<Scene::Node> nodes;
+  nodes.reserve(circles);
+  Scene::Node group{}, subgroup{};
+  for (std::size_t i = 0; i < circles; ++i) {
+    if (i % (kFanOut * kFanOut) == 0) { group = scene.add_group("g" + std::to_string(i), scene.root()); }
+    if (i % kFanOut == 0) { subgroup = scene.add_group("s" + std::to_string(i), group); }
+    nodes.push_back(scene.add_circle(1.0F, subgroup));
+  }
+
+  bench::report("Scene first frame (all dirty)", circles, bench::measure_ms([&] { bench::keep(scene.draw().size()); }, 1));
+
+  std::mt19937 gen{ 3 };
+  std::uniform_int_distribution<std::size_t> pick(0, circles - 1);
+  float radius = 1.0F;
+  // changes scattered all over the scene dirty almost every subgroup
+  bench::report("Scene frame, 1% changed, scattered", circles, bench::measure_ms([&] {
+    radius += 1.0F;
+    for (std::size_t i = 0; i < circles / 100; ++i) { scene.set_radius(nodes[pick(gen)], radius); }
+    bench::keep(scene.draw().size());
+  }, 5));
+  // the usual case: a few objects move, each with all of its siblings
+  bench::report("Scene frame, 1% changed, clustered", circles, bench::measure_ms([&] {
+    radius += 1.0F;
+    for (std::size_t i = 0; i < circles / 100; i += kFanOut) {
+      auto first = pick(gen) / kFanOut * kFanOut;
+      for (std::size_t j = first; j < std::min(circles, first + kFanOut); ++j) { scene.set_radius(nodes[j], radius); }
+    }
+    bench::keep(scene.draw().size());
+  }, 5));
+  bench::report("Scene frame, nothing changed", circles, bench::measure_ms([&] { bench::keep(scene.draw().size()); }));
+}
+
+}// namespace
+
+void run_composite_benchmarks(std::size_t limit)
+{
+  for (std::size_t nodes = 1'000; nodes <= std::min<std::size_t>(limit, 10'000'000); nodes *= 10) {
+    bench_expression(nodes);
+  }
+  bench_dag(std::min<std::size_t>(limit, 1'000'000));
+  bench_scene(std::min<std::size_t>(limit, 1'000'000));
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Bounded cache for many threads.
+// Keys are spread over shards by their hash and every shard has its own
+// mutex, store and eviction, so threads working with different keys rarely
+// meet on a lock. Values are computed outside of the lock, and only once:
+// the first caller of a missing key computes it, the others coming meanwhile
+// wait for its result (single flight).
+
+namespace eviction {
+
+/// evicts the least recently used entry
+struct lru
+{
+  template<typename Key, typename Value, typename Hash> class store
+  {
+  public:
+    Value *find(const Key &key)
+    {
+      auto it = index.find(key);
+      if (it == index.end()) { return nullptr; }
+      order.splice(order.begin(), order, it->second);
+      return &it->second->second;
+    }
+
+    /// returns true if another entry had to go
+    bool insert(const Key &key, Value value, std::size_t capacity)
+    {
+      bool evicted = false;
+      if (order.size() >= capacity) {
+        index.erase(order.back().first);
+        order.pop_back();
+        evicted = true;
+      }
+      order.emplace_front(key, std::move(value));
+      index.emplace(key, order.begin());
+      return evicted;
+    }
+
+  private:
+    std::list<std::pair<Key, Value>> order;// most recent first
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index;
+  };
+};
+
+/// CLOCK (second chance): a hit only sets a bit, no list is touched;
+/// the hand skips and clears set bits and evicts the first clear one
+struct clock
+{
+  template<typename Key, typename Value, typename Hash> class store
+  {
+  public:
+    Value *find(const Key &key)
+    {
+      auto it = index.find(key);
+      if (it == index.end()) { return nullptr; }
+      auto &slot = slots[it->second];
+      slot.referenced = true;
+      return &slot.value;
+    }
+
+    bool insert(const Key &key, Value value, std::size_t capacity)
+    {
+      if (slots.size() < capacity) {
+        index.emplace(key, slots.size());
+        slots.push_back({ key, std::move(value), false });
+        return false;
+      }
+      for (;; hand = (hand + 1) % slots.size()) {
+        if (!slots[hand].referenced) { break; }
+        slots[hand].referenced = false;
+      }
+      auto &victim = slots[hand];
+      index.erase(victim.key);
+      victim = { key, std::move(value), false };
+      index.emplace(key, hand);
+      hand = (hand + 1) % slots.size();
+      return true;
+    }
+
+  private:
+    struct Slot
+    {
+      Key key;
+      Value value;
+      bool referenced;
+    };
+
+    std::vector<Slot> slots;
+    std::unordered_map<Key, std::size_t, Hash> index;
+    std::size_t hand = 0;
+  };
+};
+
+}// namespace eviction
+
+struct cache_stats
+{
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;// computed values
+  std::uint64_t coalesced = 0;// waited for a value computed by another caller
+  std::uint64_t evictions = 0;
+};
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Eviction = eviction::lru>
+class ConcurrentCache
+{
+public:
+  using key_type = Key;
+
+  static std::size_t default_shards() { return std::bit_ceil(std::max(4U, std::thread::hardware_concurrency()) * 4); }
+
+  /// holds at most `capacity` values in total: there are no more shards than values
+  /// and the capacity is split between them
+  explicit ConcurrentCache(std::size_t capacity, std::size_t shards = default_shards())
+    : shard_list(std::clamp<std::size_t>(shards, 1, std::max<std::size_t>(1, capacity)))
+  {
+    capacity = std::max<std::size_t>(1, capacity);
+    for (std::size_t i = 0; i < shard_list.size(); ++i) {
+      shard_list[i].capacity = capacity / shard_list.size() + (i < capacity % shard_list.size() ? 1 : 0);
+    }
+  }
+
+  /// the cached value of key, or compute() stored under key;
+  /// if compute() throws, all callers waiting for it get the exception and nothing is stored
+  template<typename Compute> Value get_or_compute(const Key &key, Compute &&compute)
+  {
+    auto &shard = shard_of(key);
+    std::promise<Value> promise;
+    {
+      std::unique_lock lock{ shard.mtx };
+      if (auto *value = shard.store.find(key)) {
+        ++shard.stats.hits;
+        return *value;
+      }
+      if (auto it = shard.in_flight.find(key); it != shard.in_flight.end()) {
+        ++shard.stats.coalesced;
+        auto result = it->second;
+        lock.unlock();
+        return result.get();
+      }
+      ++shard.stats.misses;
+      shard.in_flight.emplace(key, promise.get_future().share());
+    }
+
+    std::optional<Value> value;
+    try {
+      value.emplace(compute());
+    } catch (...) {
+      std::lock_guard lock{ shard.mtx };
+      shard.in_flight.erase(key);
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    {
+      std::lock_guard lock{ shard.mtx };
+      if (shard.store.insert(key, *value, shard.capacity)) { ++shard.stats.evictions; }
+      shard.in_flight.erase(key);
+    }
+    promise.set_value(*value);
+    return std::move(*value);
+  }
+
+  /// counters summed over all shards
+  [[nodiscard]] cache_stats stats() const
+  {
+    cache_stats total;
+    for (const auto &shard : shard_list) {
+      std::lock_guard lock{ shard.mtx };
+      total.hits += shard.stats.hits;
+      total.misses += shard.stats.misses;
+      total.coalesced += shard.stats.coalesced;
+      total.evictions += shard.stats.evictions;
+    }
+    return total;
+  }
+
+  [[nodiscard]] std::size_t shards() const { return shard_list.size(); }
+
+private:
+  struct alignas(64) Shard
+  {
+    mutable std::mutex mtx;
+    typename Eviction::template store<Key, Value, Hash> store;
+    std::unordered_map<Key, std::shared_future<Value>, Hash> in_flight;
+    cache_stats stats;
+    std::size_t capacity = 1;
+  };
+
+  Shard &shard_of(const Key &key)
+  {
+    // the top bits of the hash, the store's buckets use the low ones
+    auto hash = static_cast<std::uint64_t>(Hash{}(key)) * 0x9e3779b97f4a7c15ULL;
+    return shard_list[(hash >> 32) % shard_list.size()];
+  }
+
+  std::vector<Shard> shard_list;
+};
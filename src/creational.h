@@ -1,3 +1,6 @@
 #pragma once
 
+#include <cstddef>
+
 void run_creational_examples();
+void run_creational_benchmarks(std::size_t limit);
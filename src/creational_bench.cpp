@@ -0,0 +1,202 @@
+#include "bench.h"
+#include "creational.h"
+#include "html.h"
+#include "person_builder.h"
+#include "person_columns.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <unordered_map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// document of `nodes` elements: a root with sections of 1000 items each
+void bench_html_render(std::size_t nodes)
+{
+  constexpr std::size_t kPerSection = 1000;
+  std::size_t sections = std::max<std::size_t>(1, nodes / kPerSection);
+  std::cout << "--- html document, " << sections * kPerSection << " nodes ---\n";
+
+  bench::report("HtmlElement build + str()",
+    nodes,
+    bench::measure_ms(
+      [&] {
+        HtmlElement root{ "html", "" };
+        for (std::size_t s = 0; s < sections; ++s) {
+          HtmlElement section{ "ul", "" };
+          for (std::size_t i = 0; i < kPerSection; ++i) {
+            section.elements.emplace_back("li", "item " + std::to_string(i));
+          }
+          root.elements.push_back(std::move(section));
+        }
+        // str() prints to std::cout, catch it into a string
+        std::ostringstream out;
+        auto *old = std::cout.rdbuf(out.rdbuf());
+        root.str();
+        std::cout.rdbuf(old);
+        bench::keep(out.str().size());
+      },
+      1));
+
+  auto build_arena = [&](HtmlArena &arena) {
+    auto *root = arena.make("html", {});
+    for (std::size_t s = 0; s < sections; ++s) {
+      auto *section = arena.append(root, "ul", {});
+      for (std::size_t i = 0; i < kPerSection; ++i) { arena.append(section, "li", "item " + std::to_string(i)); }
+    }
+    return root;
+  };
+
+  bench::report("HtmlArena build + render_html()", nodes, bench::measure_ms([&] {
+    HtmlArena arena;
+    bench::keep(render_html(*build_arena(arena)).size());
+  }));
+
+  HtmlArena arena;
+  const auto *root = build_arena(arena);
+  bench::report("render_html() only", nodes, bench::measure_ms([&] { bench::keep(render_html(*root).size()); }));
+  bench::report("render_html() gather list only", nodes, bench::measure_ms([&] {
+    std::vector<std::string_view> pieces;
+    render_html(*root, pieces);
+    bench::keep(pieces.size());
+  }));
+}
+
+void bench_html_streaming(std::size_t nodes)
+{
+  std::cout << "--- streaming html, " << nodes << " nodes ---\n";
+  auto write_document = [nodes](auto &sink) {
+    StreamingHtmlBuilder builder{ sink, "html" };
+    builder.open("body").open("ul");
+    for (std::size_t i = 0; i < nodes; ++i) {
+      if (i > 0 && i % 1000 == 0) { builder.close().open("ul"); }
+      builder.add_child("li", "item");
+    }
+    builder.finish();
+  };
+
+#ifndef _WIN32
+  bench::report("StreamingHtmlBuilder -> FdSink(/dev/null)", nodes, bench::measure_ms([&] {
+    int fd = ::open("/dev/null", O_WRONLY);
+    FdSink sink{ fd };
+    write_document(sink);
+    ::close(fd);
+  }));
+
+  auto path = (std::filesystem::temp_directory_path() / "patterns_streaming.html").string();
+  bench::report("StreamingHtmlBuilder -> MappedFileSink", nodes, bench::measure_ms([&] {
+    MappedFileSink sink{ path };
+    write_document(sink);
+    sink.close();
+  }));
+  std::filesystem::remove(path);
+#endif
+}
+
+void bench_person_builders(std::size_t records)
+{
+  std::cout << "--- person builders, " << records << " records ---\n";
+  // longer than the small string buffer, so every std::string allocates
+  const std::string street = "123 London Road, flat 42, the third floor";
+  const std::string city = "London, Greater London";
+  const std::string company = "PragmaSoft Consulting Ltd.";
+  const std::string position = "Senior Principal Consultant";
+
+  bench::report("faceted PersonBuilder", records, bench::measure_ms([&] {
+    std::vector<Person> people;
+    people.reserve(records);
+    for (std::size_t i = 0; i < records; ++i) {
+      people.push_back(
+        Person::create().lives().at(street).with("SW1 1GB").in(city).works().at(company).as_a(position).earning(100));
+    }
+    bench::keep(people.size());
+  }));
+
+  bench::report("typed PersonBatch builder", records, bench::measure_ms([&] {
+    PersonBatch batch;
+    batch.reserve(records);
+    for (std::size_t i = 0; i < records; ++i) {
+      batch.add().lives().at(street).with("SW1 1GB").in(city).works().at(company).as_a(position).earning(100).build();
+    }
+    bench::keep(batch.size());
+  }));
+}
+
+void bench_person_columns(std::size_t records)
+{
+  std::cout << "--- person batches, " << records << " records on " << ThreadPool::shared().size()
+            << " threads ---\n";
+  const std::string cities[] = { "London", "Paris", "Berlin", "Madrid", "Rome", "Vienna", "Prague", "Warsaw" };
+  const std::string street = "123 London Road, flat 42, the third floor";
+  auto city_of = [&](std::size_t i) -> const std::string & { return cities[i % std::size(cities)]; };
+  auto income_of = [](std::size_t i) { return static_cast<int>(30'000 + i % 70'000); };
+
+  bench::report("Person::create() one by one",
+    records,
+    bench::measure_ms(
+      [&] {
+        std::vector<Person> people;
+        people.reserve(records);
+        for (std::size_t i = 0; i < records; ++i) {
+          people.push_back(
+            Person::create().lives().at(street).in(city_of(i)).works().at("PragmaSoft").earning(income_of(i)));
+        }
+        bench::keep(people.size());
+      },
+      1));
+
+  PersonColumns columns;
+  bench::report("PersonBatchBuilder", records, bench::measure_ms([&] {
+    PersonBatchBuilder builder;
+    builder.reserve(records);
+    for (std::size_t i = 0; i < records; ++i) {
+      builder.add(street, "SW1 1GB", city_of(i), "PragmaSoft", "Consultant", income_of(i));
+    }
+    columns = std::move(builder).build();
+  }));
+
+  bench::report("PersonBatchBuilder::build_parallel", records, bench::measure_ms([&] {
+    auto built = PersonBatchBuilder::build_parallel(records, [&](std::size_t i, PersonBatchBuilder &out) {
+      out.add(street, "SW1 1GB", city_of(i), "PragmaSoft", "Consultant", income_of(i));
+    });
+    bench::keep(built.size());
+  }));
+
+  // Person hides its fields, row-wise aggregation is done over PersonRecord rows instead
+  PersonBatch rows;
+  rows.reserve(records);
+  for (std::size_t i = 0; i < records; ++i) {
+    rows.add().lives().at(street).in(city_of(i)).works().at("PragmaSoft").earning(income_of(i)).build();
+  }
+  bench::report("income per city, rows + hash map", records, bench::measure_ms([&] {
+    std::unordered_map<std::string_view, std::pair<std::int64_t, std::size_t>> per_city;
+    for (const auto &rec : rows) {
+      auto &entry = per_city[rec.city];
+      entry.first += rec.annual_income;
+      ++entry.second;
+    }
+    bench::keep(per_city.size());
+  }));
+  bench::report("income per city, columns", records, bench::measure_ms([&] {
+    bench::keep(columns.income_by_city().size());
+  }));
+  bench::report("total income, columns", records, bench::measure_ms([&] { bench::keep(columns.total_income()); }));
+}
+
+}// namespace
+
+void run_creational_benchmarks(std::size_t limit)
+{
+  bench_html_render(std::min<std::size_t>(limit, 1'000'000));
+  bench_html_streaming(limit);
+  bench_person_builders(std::min<std::size_t>(limit, 1'000'000));
+  bench_person_columns(limit);
+}
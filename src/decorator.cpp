@@ -1,62 +1,13 @@
 #include "decorator.h"
-#include <functional>
+#include "function_decorator.h"
+#include "shape.h"
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
-struct Shape
-{
-  virtual std::string str() const = 0;
-  virtual ~Shape() = default;
-};
-
-struct Circle : Shape
-{
-  float radius;
-
-  explicit Circle(const float radius) : radius(radius) {}
-
-  void resize(float factor) { radius *= factor; }
-
-  std::string str() const override
-  {
-    std::ostringstream oss;
-    oss << "A circle of radius:" << radius;
-    return oss.str();
-  }
-};
-
-// ---- Dynamic Decorators
-
-struct ColoredShape : Shape
-{
-  Shape &shape;
-  std::string color;
-
-  ColoredShape(Shape &&shape, const std::string &color) : shape(shape), color(color) {}
-
-  std::string str() const override
-  {
-    std::ostringstream oss;
-    oss << shape.str() << " has the color " << color;
-    return oss.str();
-  }
-};
-
-struct TransparentShape : Shape
-{
-  Shape &shape;
-  uint8_t transparency;
-
-  TransparentShape(Shape &&shape, uint8_t transparency) : shape(shape), transparency(transparency) {}
-
-  std::string str() const override
-  {
-    std::ostringstream oss;
-    oss << shape.str() << " has " << static_cast<float>(transparency) / 255.f * 100.f << "% transparency";
-    return oss.str();
-  }
-};
+using namespace shapes;
 
 /// ----- TEMPLATED (=Static) MAGIC:
 
@@ -100,28 +51,10 @@ template<typename T> struct TransparentTShape : T
   }
 };
 
-// need partial specialization for this to work
-template<typename> struct Logger;
-
-template<typename R, typename... Args> struct Logger<R(Args...)>
+/// the log goes to a background thread, which writes it out
+template<typename F> auto make_logger(F &&func, const std::string &name)
 {
-  Logger(std::function<R(Args...)> func, const std::string &name) : func(func), name(name) {}
-
-  R operator()(Args... args)
-  {
-    std::cout << "Entering " << name << std::endl;
-    R result = func(args...);
-    std::cout << "Exiting " << name << std::endl;
-    return result;
-  }
-
-  std::function<R(Args...)> func;
-  std::string name;
-};
-
-template<typename R, typename... Args> auto make_logger(R (*func)(Args...), const std::string &name)
-{
-  return Logger<R(Args...)>(std::function<R(Args...)>(func), name);
+  return decorators::decorate(std::forward<F>(func), decorators::logging{ name });
 }
 
 void run_decorator_mixin_examples()
@@ -133,10 +66,36 @@ void run_decorator_mixin_examples()
   std::cout << circle.str() << std::endl;
 }
 
+void run_decorator_value_examples()
+{
+  // the decorators own their shapes, temporaries are fine here
+  ShapeValue shape = Transparent{ Colored{ Circle{ 23 }, "green" }, 64 };
+  std::string text;
+  format_to(text, shape);
+  std::cout << text << (shape.on_heap() ? " (on the heap)" : " (inline)") << std::endl;
+
+  // decorated once more at run time, the decoration is added as a layer
+  ShapeValue red = Colored<>{ shape, "red" };
+  char buf[128];
+  auto *end = format_to(buf, red);
+  std::cout << std::string_view(buf, static_cast<std::size_t>(end - buf)) << std::endl;
+}
+
+namespace {
+/// the log is written by another thread, its lines are flushed
+/// before anything is printed, so the output comes in order
+std::ostream &out()
+{
+  std::cout.flush();
+  decorators::AsyncLog::instance().flush();
+  return std::cout;
+}
+}// namespace
+
 /// an example function to be decorated:
 double add(double a, double b)
 {
-  std::cout << a << "+" << b << "=" << (a + b) << std::endl;
+  out() << a << "+" << b << "=" << (a + b) << std::endl;
   return a + b;
 }
 
@@ -144,12 +103,43 @@ void run_decorator_fun_examples()
 {
   auto logged_add = make_logger(add, "Add");
   auto result = logged_add(3, 5);
-  std::cout << "res: " << result << std::endl;
+  out() << "res: " << result << std::endl;
+
+  // stacked decorators, the first one is the outermost
+  decorators::call_stats stats;
+  auto square = decorators::decorate([](int x) { return x * x; },
+    decorators::counting{ &stats },
+    decorators::logging{ "square", 2 },
+    decorators::caching<int(int)>{});
+  for (int i = 0; i < 4; ++i) { square(i % 2); }
+  out() << "square called " << stats.calls << " times, computed " << square.get<2>().results.size() << " times"
+        << std::endl;
+
+  // void results, references and move-only arguments pass through as they are
+  std::vector<int> items;
+  auto push = decorators::decorate([&items](std::unique_ptr<int> item) -> int & { return items.emplace_back(*item); },
+    decorators::timing{ &stats });
+  push(std::make_unique<int>(1)) = 2;
+  auto print = decorators::decorate([](int x) { std::cout << "item " << x << std::endl; }, decorators::timing{ &stats });
+  print(items.front());
+
+  // add() prints when it's really called, the second call comes from the cache
+  auto memo_add = decorators::make_memoized(add, 1024);
+  memo_add(1, 2);
+  memo_add(1, 2);
+  auto memo_stats = memo_add.get<0>().stats();
+  out() << "memoized add: " << memo_stats.hits << " hit, " << memo_stats.misses << " miss" << std::endl;
+
+  std::cout.flush();
+  decorators::AsyncLog::instance().flush();
 }
 
 void run_decorator_examples()
 {
-  TransparentShape myCicle{ ColoredShape{ Circle(23), "green" }, 64 };
+  // the decorators keep references, so every layer has to outlive them
+  Circle circle{ 23 };
+  ColoredShape colored{ std::move(circle), "green" };
+  TransparentShape myCicle{ std::move(colored), 64 };
   std::cout << myCicle.str() << std::endl;
   /*
   // SEGVed
@@ -158,6 +148,7 @@ void run_decorator_examples()
   TransparentShape anotherCicle{ shaped, 64 };
   std::cout << anotherCicle.str() << std::endl;
   */
+  run_decorator_value_examples();
   run_decorator_mixin_examples();
   run_decorator_fun_examples();
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+
 // decorator is a proxy object
 // which contains all the objects (and their interfaces) it was composed of
 
 void run_decorator_examples();
+void run_decorator_benchmarks(std::size_t limit);
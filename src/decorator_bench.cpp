@@ -0,0 +1,208 @@
+#include "bench.h"
+#include "decorator.h"
+#include "function_decorator.h"
+#include "shape.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace shapes;
+
+namespace {
+
+void bench_shapes(std::size_t count)
+{
+  std::cout << "--- " << count << " circles, colored and transparent ---\n";
+
+  // reference decorators need every layer to stay where it is
+  std::vector<Circle> circles;
+  std::vector<ColoredShape> colored;
+  std::vector<TransparentShape> transparent;
+  circles.reserve(count);
+  colored.reserve(count);
+  transparent.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    circles.emplace_back(static_cast<float>(i % 1000));
+    colored.emplace_back(std::move(circles.back()), "green");
+    transparent.emplace_back(std::move(colored.back()), static_cast<std::uint8_t>(i));
+  }
+
+  bench::report("TransparentShape::str()", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (const auto &shape : transparent) { total += shape.str().size(); }
+    bench::keep(total);
+  }));
+
+  std::vector<ShapeValue> values;
+  values.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    values.emplace_back(
+      Transparent{ Colored{ Circle{ static_cast<float>(i % 1000) }, "green" }, static_cast<std::uint8_t>(i) });
+  }
+
+  // one buffer for all shapes, emptied when it gets big
+  std::string buffer;
+  buffer.reserve(1 << 20);
+  bench::report("ShapeValue format_to(string)", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (const auto &shape : values) {
+      if (buffer.size() > (1 << 20) - 256) {
+        total += buffer.size();
+        buffer.clear();
+      }
+      format_to(buffer, shape);
+    }
+    bench::keep(total + buffer.size());
+    buffer.clear();
+  }));
+
+  std::vector<char> chars(1 << 20);
+  bench::report("ShapeValue format_to(char *)", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    char *out = chars.data();
+    for (const auto &shape : values) {
+      if (out > chars.data() + chars.size() - 256) {
+        total += static_cast<std::size_t>(out - chars.data());
+        out = chars.data();
+      }
+      out = format_to(out, shape);
+    }
+    bench::keep(total + static_cast<std::size_t>(out - chars.data()));
+  }));
+
+  // composed at run time: the circle is inline, the decorations are a list of layers
+  std::vector<ShapeValue> runtime;
+  runtime.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    runtime.emplace_back(Transparent<>{ Colored<>{ Circle{ static_cast<float>(i % 1000) }, "green" }, 64 });
+  }
+  bench::report("Transparent<ShapeValue> format_to()", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (const auto &shape : runtime) {
+      if (buffer.size() > (1 << 20) - 256) {
+        total += buffer.size();
+        buffer.clear();
+      }
+      format_to(buffer, shape);
+    }
+    bench::keep(total + buffer.size());
+    buffer.clear();
+  }));
+}
+
+// calls f(i) for i < count and sums the results
+template<typename F> double call_loop(F &f, std::size_t count)
+{
+  return bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < count; ++i) { sum += f(i % 1024); }
+    bench::keep(sum);
+  });
+}
+
+void bench_function_decorators(std::size_t count)
+{
+  using namespace decorators;
+  std::cout << "--- " << count << " calls of a decorated function ---\n";
+
+  auto work = [](std::uint64_t x) { return (x * 2654435761U) ^ (x >> 3); };
+  bench::report("direct call", count, call_loop(work, count));
+
+  std::function<std::uint64_t(std::uint64_t)> erased = work;
+  bench::report("std::function", count, call_loop(erased, count));
+
+  auto bare = decorate(work);
+  bench::report("decorate()", count, call_loop(bare, count));
+
+  call_stats stats;
+  auto counted = decorate(work, counting{ &stats });
+  bench::report("decorate(counting)", count, call_loop(counted, count));
+
+  auto timed = decorate(work, counting{ &stats }, timing{ &stats });
+  bench::report("decorate(counting, timing)", count, call_loop(timed, count));
+
+  // the lines go to a temporary file, the log drops what it can't keep up with
+  auto *file = std::tmpfile();
+  if (file) { AsyncLog::instance().set_output(file); }
+  auto logged = decorate(work, counting{ &stats }, logging{ "work", 1024 });
+  bench::report("decorate(counting, logging 1/1024)", count, call_loop(logged, count));
+  auto all_logged = decorate(work, logging{ "work" });
+  bench::report("decorate(logging every call)", count / 10, call_loop(all_logged, count / 10));
+  AsyncLog::instance().flush();
+  std::cout << "log lines dropped: " << AsyncLog::instance().dropped() << "\n";
+  AsyncLog::instance().set_output(stdout);
+  if (file) { std::fclose(file); }
+
+  auto cached = decorate(work, counting{ &stats }, caching<std::uint64_t(std::uint64_t)>{});
+  bench::report("decorate(counting, caching)", count, call_loop(cached, count));
+}
+
+// a pure function worth caching, about a microsecond
+std::uint64_t expensive(std::uint64_t x)
+{
+  for (int i = 0; i < 1000; ++i) { x = (x ^ (x >> 31)) * 0x7fb5d329728ea185ULL; }
+  return x;
+}
+
+// every thread calls f with keys from a skewed set (7 of 8 calls use 1/16 of the keys)
+template<typename F> void run_threads(const std::string &name, F &f, std::size_t threads, std::size_t calls)
+{
+  constexpr std::uint64_t kKeys = 16 * 1024;
+  auto ms = bench::measure_ms([&] {
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&f, t, calls, threads] {
+        std::uint64_t sum = 0, key = t;
+        for (std::size_t i = 0; i < calls / threads; ++i) {
+          key = key * 6364136223846793005ULL + 1442695040888963407ULL;
+          auto k = (key >> 33) % kKeys;
+          sum += f(i % 8 ? k % (kKeys / 16) : k);
+        }
+        bench::keep(sum);
+      });
+    }
+    for (auto &w : workers) { w.join(); }
+  }, 1);
+  bench::report(name + " x" + std::to_string(threads), calls, ms);
+}
+
+void bench_memoized(std::size_t calls)
+{
+  using namespace decorators;
+  std::cout << "--- " << calls << " calls of a memoized function, capacity 4096 of 16384 keys, "
+            << std::thread::hardware_concurrency() << " cores ---\n";
+
+  for (std::size_t threads : { 1U, 2U, 4U, 8U }) {
+    auto plain = expensive;
+    run_threads("undecorated", plain, threads, calls);
+
+    auto single = decorate(expensive, memoizing<std::uint64_t(std::uint64_t)>{ 4096, 1 });
+    run_threads("single mutex LRU", single, threads, calls);
+
+    auto lru = make_memoized(expensive, 4096);
+    run_threads("sharded LRU", lru, threads, calls);
+
+    auto clock = make_memoized(expensive, 4096, eviction::clock{});
+    run_threads("sharded CLOCK", clock, threads, calls);
+
+    if (threads == 8) {
+      auto stats = clock.get<0>().stats();
+      std::cout << "CLOCK: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.coalesced
+                << " coalesced, " << stats.evictions << " evictions\n";
+    }
+  }
+}
+
+}// namespace
+
+void run_decorator_benchmarks(std::size_t limit)
+{
+  bench_shapes(std::min<std::size_t>(limit, 1'000'000));
+  bench_function_decorators(limit);
+  bench_memoized(std::min<std::size_t>(limit, 1'000'000));
+}
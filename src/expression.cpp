@@ -0,0 +1,106 @@
+#include "expression.h"
+#include <algorithm>
+#include <stdexcept>
+
+ExpressionProgram ExpressionProgram::compile(Expression &root)
+{
+  ExpressionProgram program;
+
+  // post-order walk with an explicit stack: a node is emitted
+  // the second time it's seen, after both of its children
+  struct Frame
+  {
+    Expression *node;
+    bool expanded;
+  };
+  std::vector<Frame> frames{ { &root, false } };
+  std::size_t depth = 0;
+
+  while (!frames.empty()) {
+    auto [node, expanded] = frames.back();
+    frames.pop_back();
+
+    if (auto *lit = dynamic_cast<Literal *>(node)) {
+      program.code.push_back({ Op::Load, static_cast<std::uint32_t>(program.literals.size()) });
+      program.literals.push_back(lit->value);
+      program.max_stack = std::max(program.max_stack, ++depth);
+    } else if (auto *add = dynamic_cast<AdditionExpression *>(node)) {
+      if (expanded) {
+        program.code.push_back({ Op::Add, 0 });
+        --depth;
+      } else {
+        frames.push_back({ node, true });
+        frames.push_back({ add->right.get(), false });
+        frames.push_back({ add->left.get(), false });
+      }
+    } else {
+      program.code.push_back({ Op::Call, static_cast<std::uint32_t>(program.externals.size()) });
+      program.externals.push_back(node);
+      program.max_stack = std::max(program.max_stack, ++depth);
+    }
+  }
+  program.stack.resize(program.max_stack);
+  return program;
+}
+
+double ExpressionProgram::run(std::span<const double> bindings) const
+{
+  if (bindings.size() < literals.size()) { throw std::invalid_argument("ExpressionProgram: not enough bindings"); }
+
+  double *top = stack.data();// points past the last value
+  for (const auto &ins : code) {
+    switch (ins.op) {
+    case Op::Load:
+      *top++ = bindings[ins.arg];
+      break;
+    case Op::Add:
+      --top;
+      top[-1] += *top;
+      break;
+    case Op::Call:
+      *top++ = externals[ins.arg]->eval();
+      break;
+    }
+  }
+  return stack.front();
+}
+
+void ExpressionProgram::run_batch(std::span<const double> bindings, std::span<double> out) const
+{
+  const std::size_t sets = out.size();
+  if (bindings.size() < literals.size() * sets) {
+    throw std::invalid_argument("ExpressionProgram: not enough bindings");
+  }
+
+  // sets are processed in blocks, so the whole value stack stays in cache
+  constexpr std::size_t kBlock = 256;
+  std::vector<double> columns(max_stack * kBlock);
+
+  for (std::size_t first = 0; first < sets; first += kBlock) {
+    const std::size_t count = std::min(kBlock, sets - first);
+    double *top = columns.data();
+
+    for (const auto &ins : code) {
+      switch (ins.op) {
+      case Op::Load: {
+        const double *src = bindings.data() + ins.arg * sets + first;
+        std::copy(src, src + count, top);
+        top += kBlock;
+        break;
+      }
+      case Op::Add: {
+        top -= kBlock;
+        double *dst = top - kBlock;
+        const double *src = top;
+        for (std::size_t i = 0; i < count; ++i) { dst[i] += src[i]; }
+        break;
+      }
+      case Op::Call:
+        std::fill(top, top + count, externals[ins.arg]->eval());
+        top += kBlock;
+        break;
+      }
+    }
+    std::copy(columns.data(), columns.data() + count, out.data() + first);
+  }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// acuumulators
+// 2 + (3+4)
+struct Expression
+{
+  virtual ~Expression() = default;
+  virtual double eval() = 0;
+  virtual void collect(std::vector<double> &v) = 0;
+};
+
+struct Literal : Expression
+{
+  double value;
+
+  explicit Literal(const double value) : value{ value } {}
+
+  double eval() override { return value; }
+
+  void collect(std::vector<double> &v) override { v.push_back(value); }
+};
+
+struct AdditionExpression : Expression
+{
+  std::shared_ptr<Expression> left, right;
+
+  AdditionExpression(const std::shared_ptr<Expression> &expression, const std::shared_ptr<Expression> &expression1)
+    : left{ expression }, right{ expression1 }
+  {}
+
+  double eval() override { return left->eval() + right->eval(); }
+
+  void collect(std::vector<double> &v) override
+  {
+    left->collect(v);
+    right->collect(v);
+  }
+};
+
+// Flattened expression.
+// eval() above makes a virtual call per node and follows a pointer per
+// child. ExpressionProgram is the same tree lowered into postfix bytecode
+// kept in one contiguous array, run by a loop over a small value stack.
+// Every Literal becomes a slot, so the program may be run with other
+// values bound to the literals, one set at a time or many sets at once.
+
+struct ExpressionProgram
+{
+  enum class Op : std::uint8_t {
+    Load,// pushes literal slot `arg`
+    Add,// pops two values, pushes their sum
+    Call,// pushes externals[arg]->eval(), for node types the compiler doesn't know
+  };
+
+  struct Instruction
+  {
+    Op op;
+    std::uint32_t arg;
+  };
+
+  std::vector<Instruction> code;
+  /// values of literals in the order collect() gives them
+  std::vector<double> literals;
+  std::vector<Expression *> externals;
+  std::size_t max_stack = 0;
+
+  /// lowers a tree into bytecode, works without recursion on any depth
+  static ExpressionProgram compile(Expression &root);
+
+  /// evaluates with the literal values the tree had at compile time
+  [[nodiscard]] double run() const { return run(literals); }
+  /// evaluates with other values bound to the literals (one per slot)
+  [[nodiscard]] double run(std::span<const double> bindings) const;
+
+  /// evaluates the program for out.size() sets of bindings at once,
+  /// values of slot s are bindings[s * out.size(), (s + 1) * out.size()).
+  /// Every instruction processes a block of sets, so the interpreter
+  /// overhead is paid once per block and the additions are vectorized.
+  void run_batch(std::span<const double> bindings, std::span<double> out) const;
+
+private:
+  // value stack of run(), sized by compile() to max_stack and reused by every run,
+  // so a program must not be run from several threads at once (copy it instead)
+  mutable std::vector<double> stack;
+};
@@ -0,0 +1,132 @@
+#include "expression_dag.h"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <stdexcept>
+
+ExpressionDag::id ExpressionDag::push(Node node, double value)
+{
+  auto node_id = static_cast<id>(nodes.size());
+  nodes.push_back(node);
+  values.push_back(value);
+  return node_id;
+}
+
+ExpressionDag::id ExpressionDag::input(double value) { return push({ Kind::Input }, value); }
+
+ExpressionDag::id ExpressionDag::constant(double value)
+{
+  auto [it, inserted] = constants.try_emplace(std::bit_cast<std::uint64_t>(value), 0);
+  if (inserted) { it->second = push({ Kind::Constant }, value); }
+  return it->second;
+}
+
+ExpressionDag::id ExpressionDag::add(id left, id right)
+{
+  if (left >= nodes.size() || right >= nodes.size()) { throw std::out_of_range("ExpressionDag: unknown node"); }
+
+  // addition is commutative, so both orders are the same node
+  if (left > right) { std::swap(left, right); }
+  auto [it, inserted] = sums.try_emplace(std::uint64_t{ left } << 32 | right, 0);
+  if (!inserted) { return it->second; }
+
+  // the new node is computed from current values, pending changes included
+  auto sum = value(left) + value(right);
+  auto node_id = push({ Kind::Add, false, left, right }, sum);
+  it->second = node_id;
+
+  uses.push_back({ node_id, nodes[left].first_use });
+  nodes[left].first_use = static_cast<std::uint32_t>(uses.size() - 1);
+  if (right != left) {
+    uses.push_back({ node_id, nodes[right].first_use });
+    nodes[right].first_use = static_cast<std::uint32_t>(uses.size() - 1);
+  }
+  return node_id;
+}
+
+ExpressionDag::id ExpressionDag::import(Expression &root, std::vector<id> *inputs)
+{
+  // post-order walk with an explicit stack, so any depth works;
+  // objects reachable twice (shared_ptr) are converted once
+  std::unordered_map<const Expression *, id> done;
+  struct Frame
+  {
+    Expression *node;
+    bool expanded;
+  };
+  std::vector<Frame> stack{ { &root, false } };
+
+  while (!stack.empty()) {
+    auto [node, expanded] = stack.back();
+    stack.pop_back();
+    if (done.contains(node)) { continue; }
+
+    if (auto *lit = dynamic_cast<Literal *>(node)) {
+      if (inputs) {
+        done[node] = input(lit->value);
+        inputs->push_back(done[node]);
+      } else {
+        done[node] = constant(lit->value);
+      }
+    } else if (auto *sum = dynamic_cast<AdditionExpression *>(node)) {
+      if (expanded) {
+        done[node] = add(done.at(sum->left.get()), done.at(sum->right.get()));
+      } else {
+        stack.push_back({ node, true });
+        stack.push_back({ sum->right.get(), false });
+        stack.push_back({ sum->left.get(), false });
+      }
+    } else {
+      throw std::invalid_argument("ExpressionDag: only Literal and AdditionExpression can be imported");
+    }
+  }
+  return done.at(&root);
+}
+
+void ExpressionDag::set(id input, double value)
+{
+  if (input >= nodes.size() || nodes[input].kind != Kind::Input) {
+    throw std::invalid_argument("ExpressionDag: only inputs can be set");
+  }
+  if (values[input] == value) { return; }
+  values[input] = value;
+  queue_users(input);
+}
+
+void ExpressionDag::queue_users(id node)
+{
+  for (auto u = nodes[node].first_use; u != kNone; u = uses[u].next) {
+    auto user = uses[u].user;
+    if (nodes[user].queued) { continue; }
+    nodes[user].queued = true;
+    pending.push_back(user);
+    std::push_heap(pending.begin(), pending.end(), std::greater<>{});
+  }
+}
+
+void ExpressionDag::update()
+{
+  last_recomputed = 0;
+  // smallest id first: all operands of a node are final when it's recomputed
+  while (!pending.empty()) {
+    std::pop_heap(pending.begin(), pending.end(), std::greater<>{});
+    auto node_id = pending.back();
+    pending.pop_back();
+
+    auto &node = nodes[node_id];
+    node.queued = false;
+    ++last_recomputed;
+
+    auto sum = values[node.left] + values[node.right];
+    if (sum == values[node_id]) { continue; }
+    values[node_id] = sum;
+    queue_users(node_id);
+  }
+}
+
+double ExpressionDag::value(id node)
+{
+  if (node >= nodes.size()) { throw std::out_of_range("ExpressionDag: unknown node"); }
+  if (!pending.empty()) { update(); }
+  return values[node];
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "expression.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Incremental expression DAG.
+// A tree of Expression objects keeps every copy of a common subexpression
+// and eval() recomputes everything after any change. ExpressionDag stores
+// nodes hash-consed, so an Add of the same operands (in any order) or a
+// constant of the same value exists once. Every node caches its value and
+// knows its users. set() of an input queues its users, and the next value()
+// recomputes only the queued nodes, in id order (operands are always created
+// before their users, so id order is a topological order). A node whose value
+// didn't change stops the propagation.
+
+class ExpressionDag
+{
+public:
+  using id = std::uint32_t;
+
+  /// a leaf which can be changed with set(), inputs are never merged
+  id input(double value);
+  /// an immutable leaf, equal constants are the same node
+  id constant(double value);
+  /// sum of two nodes, equal sums are the same node
+  id add(id left, id right);
+
+  /// adds a tree of Literal/AdditionExpression nodes, returns its root.
+  /// Literals become constants, unless `inputs` is given: then every distinct
+  /// Literal object becomes an input and their ids are appended to it in
+  /// the order collect() visits them.
+  id import(Expression &root, std::vector<id> *inputs = nullptr);
+
+  void set(id input, double value);
+  /// value of a node, with all pending changes applied
+  double value(id node);
+
+  [[nodiscard]] std::size_t size() const { return nodes.size(); }
+  /// number of nodes recomputed by the last update
+  [[nodiscard]] std::size_t recomputed() const { return last_recomputed; }
+
+private:
+  enum class Kind : std::uint8_t { Input, Constant, Add };
+
+  struct Node
+  {
+    Kind kind;
+    bool queued = false;
+    id left = 0, right = 0;
+    std::uint32_t first_use = kNone;// head of the list of users
+  };
+
+  // list of users of a node: use u belongs to node user[u], next[u] is the next use
+  struct Use
+  {
+    id user;
+    std::uint32_t next;
+  };
+
+  static constexpr std::uint32_t kNone = UINT32_MAX;
+
+  id push(Node node, double value);
+  void queue_users(id node);
+  void update();
+
+  std::vector<Node> nodes;
+  std::vector<double> values;
+  std::vector<Use> uses;
+  // min-heap of queued node ids
+  std::vector<id> pending;
+  std::size_t last_recomputed = 0;
+
+  std::unordered_map<std::uint64_t, id> constants;// by bit pattern
+  std::unordered_map<std::uint64_t, id> sums;// by (smaller operand, bigger operand)
+};
@@ -1,45 +1,35 @@
 #include "flyweight.h"
+#include "formatted_text.h"
+#include "string_interner.h"
+#include "string_pool.h"
+#include <filesystem>
 #include <iostream>
-#include <map>
 #include <ostream>
-#include <string>
+#include <string_view>
+#include <vector>
 
-using nkey = uint32_t;
+using nkey = StringInterner::id;
 
-static std::map<std::string, nkey> names;
-static std::map<nkey, std::string> keys;
-static nkey seed;
+// names of all users, safe to use from many threads
+static StringInterner &names()
+{
+  static StringInterner interner;
+  return interner;
+}
 
 struct User
 {
-  User(const std::string &first_name, const std::string &surname)
+  User(std::string_view first_name, std::string_view surname)
     : first_name(add(first_name)), surname(add(surname))
   {}
 
-  [[nodiscard]] const std::string &get_first_name() const
-  {
-    return keys.find(first_name)->second;
-  }
+  [[nodiscard]] std::string_view get_first_name() const { return names()[first_name]; }
 
-  [[nodiscard]] const std::string &get_surname() const
-  {
-    return keys.find(surname)->second;
-  }
+  [[nodiscard]] std::string_view get_surname() const { return names()[surname]; }
 
 protected:
   nkey first_name, surname;
-  static nkey add(const std::string &name)
-  {
-    auto it = names.find(name);
-    if (it == names.end()) {
-      nkey next = ++seed;
-      // make bidirectional link number <-> string
-      names.insert({ name, next });
-      keys.insert({ next, name });
-      return next;
-    }
-    return it->second;
-  }
+  static nkey add(std::string_view name) { return names().intern(name); }
 
   friend std::ostream &operator<<(std::ostream &oss, const User &obj)
   {
@@ -48,6 +38,35 @@ protected:
   }
 };
 
+// names saved in a file which is mapped back at the next start
+void string_pool_examples()
+{
+#ifndef _WIN32
+  auto path = (std::filesystem::temp_directory_path() / "flyweight_names.pool").string();
+  std::vector<std::string_view> known{ "John", "Jane", "Doe" };
+  string_pool::write(path, known);
+
+  MappedStringPool pool{ path };
+  auto mike = pool.intern("Mike");// not in the file, goes to the overlay
+  std::cout << "Jane is " << pool.intern("Jane") << ", Mike is " << mike << " (" << pool.overlay_size()
+            << " in the overlay)" << std::endl;
+
+  pool.compact();
+  std::cout << "after compaction " << pool[mike] << " is still " << mike << ", " << pool.file_size()
+            << " names in the file" << std::endl;
+  std::filesystem::remove(path);
+#endif
+}
+
+// formatting is kept for ranges of the text, not for every word or character
+void formatted_text_examples()
+{
+  FormattedText text{ "alpha beta gamma delta" };
+  text.format_word(1, capitalize);
+  text.format(6, 16, bold);
+  std::cout << text.render() << " (" << text.run_count() << " runs)" << std::endl;
+}
+
 void run_flyweight_examples()
 {
   User john_doe{ "John", "Doe" };
@@ -57,4 +76,7 @@ void run_flyweight_examples()
   std::cout << john_doe << std::endl
             << mike_doe << std::endl
             << jane_doe << std::endl;
+
+  string_pool_examples();
+  formatted_text_examples();
 }
@@ -1,4 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 // composite is like a proxy too
 void run_flyweight_examples();
+void run_flyweight_benchmarks(std::size_t limit);
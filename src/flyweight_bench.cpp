@@ -0,0 +1,282 @@
+#include "bench.h"
+#include "flyweight.h"
+#include "formatted_text.h"
+#include "string_interner.h"
+#include "string_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// bytes allocated from the heap right now, 0 where it can't be told
+std::size_t heap_in_use()
+{
+#if defined(__GLIBC__)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+// the interning of the original flyweight: two maps and a counter
+struct MapNames
+{
+  std::map<std::string, std::uint32_t> names;
+  std::map<std::uint32_t, std::string> keys;
+  std::uint32_t seed = 0;
+  std::mutex mtx;// only used by the multithreaded run, the original has none
+
+  std::uint32_t add(const std::string &name)
+  {
+    auto it = names.find(name);
+    if (it == names.end()) {
+      std::uint32_t next = ++seed;
+      names.insert({ name, next });
+      keys.insert({ next, name });
+      return next;
+    }
+    return it->second;
+  }
+};
+
+// names looking like "user_<number>", every one is used `repeats` times in random order
+struct Workload
+{
+  std::vector<std::string> unique;
+  std::vector<std::uint32_t> order;
+
+  Workload(std::size_t calls, std::size_t repeats)
+  {
+    unique.reserve(calls / repeats);
+    for (std::size_t i = 0; i < calls / repeats; ++i) {
+      unique.push_back("user_" + std::to_string(i * 2654435761ULL % 1'000'000'007ULL));
+    }
+    order.reserve(calls);
+    std::uint64_t state = 1;
+    for (std::size_t i = 0; i < calls; ++i) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      order.push_back(static_cast<std::uint32_t>((state >> 33) % unique.size()));
+    }
+  }
+};
+
+// runs body(first, last) over `threads` equal parts of [0, count)
+template<typename Body> void in_threads(std::size_t threads, std::size_t count, Body body)
+{
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&body, t, threads, count] { body(count * t / threads, count * (t + 1) / threads); });
+  }
+  for (auto &w : workers) { w.join(); }
+}
+
+void bench_interning(std::size_t calls)
+{
+  constexpr std::size_t kRepeats = 10;
+  Workload work{ calls, kRepeats };
+  std::cout << "--- interning " << calls << " names, " << work.unique.size() << " unique ---\n";
+
+  {
+    auto before = heap_in_use();
+    MapNames maps;
+    bench::report("two std::maps", calls, bench::measure_ms([&] {
+      std::uint64_t sum = 0;
+      for (auto idx : work.order) { sum += maps.add(work.unique[idx]); }
+      bench::keep(sum);
+    }, 1));
+    if (before) { std::cout << "maps: " << (heap_in_use() - before) / work.unique.size() << " bytes per unique name\n"; }
+  }
+  {
+    auto before = heap_in_use();
+    StringInterner interner;
+    bench::report("StringInterner", calls, bench::measure_ms([&] {
+      std::uint64_t sum = 0;
+      for (auto idx : work.order) { sum += interner.intern(work.unique[idx]); }
+      bench::keep(sum);
+    }, 1));
+    if (before) {
+      std::cout << "interner: " << (heap_in_use() - before) / work.unique.size() << " bytes per unique name ("
+                << interner.memory_usage() / work.unique.size() << " counted by memory_usage)\n";
+    }
+    bench::report("StringInterner id -> name", calls, bench::measure_ms([&] {
+      std::size_t total = 0;
+      for (std::uint32_t i = 0; i < calls; ++i) {
+        total += interner[static_cast<StringInterner::id>(i % interner.size())].size();
+      }
+      bench::keep(total);
+    }));
+  }
+
+  for (std::size_t threads : { 2U, 4U, 8U, 32U }) {
+    MapNames maps;
+    bench::report("std::maps + mutex x" + std::to_string(threads), calls, bench::measure_ms([&] {
+      in_threads(threads, calls, [&](std::size_t first, std::size_t last) {
+        std::uint64_t sum = 0;
+        for (auto i = first; i < last; ++i) {
+          std::lock_guard lock{ maps.mtx };
+          sum += maps.add(work.unique[work.order[i]]);
+        }
+        bench::keep(sum);
+      });
+    }, 1));
+
+    StringInterner interner;
+    bench::report("StringInterner x" + std::to_string(threads), calls, bench::measure_ms([&] {
+      in_threads(threads, calls, [&](std::size_t first, std::size_t last) {
+        std::uint64_t sum = 0;
+        for (auto i = first; i < last; ++i) { sum += interner.intern(work.unique[work.order[i]]); }
+        bench::keep(sum);
+      });
+    }, 1));
+  }
+}
+
+void bench_string_pool(std::size_t count)
+{
+#ifndef _WIN32
+  std::cout << "--- startup and lookups with " << count << " names ---\n";
+  Workload work{ count, 1 };
+  auto dir = std::filesystem::temp_directory_path();
+  auto text_path = (dir / "bench_names.txt").string();
+  auto pool_path = (dir / "bench_names.pool").string();
+  {
+    std::ofstream out{ text_path };
+    for (const auto &name : work.unique) { out << name << '\n'; }
+  }
+  std::vector<std::string_view> views(work.unique.begin(), work.unique.end());
+  bench::report("string_pool::write", count, bench::measure_ms([&] { string_pool::write(pool_path, views); }, 1));
+
+  // the current startup: read the list and build both maps
+  std::unique_ptr<MapNames> maps;
+  bench::report("startup: read + build std::maps", count, bench::measure_ms([&] {
+    maps = std::make_unique<MapNames>();
+    std::ifstream in{ text_path };
+    for (std::string name; std::getline(in, name);) { maps->add(name); }
+  }, 1));
+
+  std::unique_ptr<StringInterner> interner;
+  bench::report("startup: read + StringInterner", count, bench::measure_ms([&] {
+    interner = std::make_unique<StringInterner>();
+    std::ifstream in{ text_path };
+    for (std::string name; std::getline(in, name);) { interner->intern(name); }
+  }, 1));
+
+  std::unique_ptr<MappedStringPool> pool;
+  bench::report("startup: MappedStringPool", count, bench::measure_ms([&] {
+    pool = std::make_unique<MappedStringPool>(pool_path);
+  }, 1));
+
+  bench::report("lookup: std::map", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto idx : work.order) { sum += maps->names.find(work.unique[idx])->second; }
+    bench::keep(sum);
+  }));
+  bench::report("lookup: MappedStringPool", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    MappedStringPool::id key = 0;
+    for (auto idx : work.order) {
+      if (pool->find(work.unique[idx], key)) { sum += key; }
+    }
+    bench::keep(sum);
+  }));
+  bench::report("id -> name: MappedStringPool", count, bench::measure_ms([&] {
+    std::size_t total = 0;
+    for (auto idx : work.order) { total += (*pool)[idx].size(); }
+    bench::keep(total);
+  }));
+
+  // a tenth new names, then written back
+  bench::report("intern new names into the overlay", count / 10, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < count / 10; ++i) { pool->intern("new_" + std::to_string(i)); }
+  }, 1));
+  bench::report("compact", pool->size(), bench::measure_ms([&] { pool->compact(); }, 1));
+
+  pool.reset();
+  std::filesystem::remove(text_path);
+  std::filesystem::remove(pool_path);
+#endif
+}
+
+// the Sentence of the tests: words in a vector, a map of tokens, words copied on output
+struct WordSentence
+{
+  std::vector<std::string> words;
+  std::map<std::size_t, bool> capitalized;
+
+  [[nodiscard]] std::string str() const
+  {
+    std::ostringstream oss;
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      std::string w = words[i];
+      if (auto t = capitalized.find(i); t != capitalized.end() && t->second) {
+        std::transform(w.begin(), w.end(), w.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+      }
+      oss << w;
+      if (i + 1 != words.size()) { oss << ' '; }
+    }
+    return oss.str();
+  }
+};
+
+void bench_formatted_text(std::size_t bytes)
+{
+  std::string text;
+  text.reserve(bytes + 16);
+  std::vector<std::size_t> starts;
+  std::uint64_t state = 7;
+  while (text.size() < bytes) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    if (!text.empty()) { text += ' '; }
+    starts.push_back(text.size());
+    for (auto len = 2 + (state >> 60) % 9; len > 0; --len) { text += static_cast<char>('a' + (state >> (len * 5)) % 26); }
+  }
+  std::cout << "--- formatting " << text.size() / 1'000'000 << " MB, " << starts.size() << " words ---\n";
+
+  // every 4th word capitalized
+  WordSentence sentence;
+  sentence.words.reserve(starts.size());
+  for (std::size_t i = 0; i < starts.size(); ++i) {
+    auto end = i + 1 < starts.size() ? starts[i + 1] - 1 : text.size();
+    sentence.words.emplace_back(text, starts[i], end - starts[i]);
+    if (i % 4 == 0) { sentence.capitalized[i] = true; }
+  }
+  FormattedText formatted{ text };
+  for (std::size_t i = 0; i < starts.size(); i += 4) { formatted.format_word(i, capitalize); }
+
+  bench::report("words + map of tokens", text.size(), bench::measure_ms([&] { bench::keep(sentence.str()); }, 1));
+  bench::report("FormattedText::render", text.size(), bench::measure_ms([&] { bench::keep(formatted.render()); }));
+
+  // a range covering everything, so only the copying is left
+  FormattedText upper{ text };
+  upper.format(0, upper.size(), capitalize);
+  std::string out(text.size(), '\0');
+  bench::report("uppercase: std::toupper", text.size(), bench::measure_ms([&] {
+    std::transform(text.begin(), text.end(), out.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    bench::keep(out);
+  }));
+  bench::report("uppercase: FormattedText::render", text.size(), bench::measure_ms([&] { bench::keep(upper.render()); }));
+}
+
+}// namespace
+
+void run_flyweight_benchmarks(std::size_t limit)
+{
+  bench_interning(std::min<std::size_t>(limit, 2'000'000));
+  bench_string_pool(std::min<std::size_t>(limit, 1'000'000));
+  // 100 MB with the default limit
+  bench_formatted_text(std::min<std::size_t>(limit, 10'000'000) * 10);
+}
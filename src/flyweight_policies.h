@@ -0,0 +1,147 @@
+#pragma once
+
+#include <boost/flyweight.hpp>
+#include <boost/flyweight/factory_tag.hpp>
+#include <boost/flyweight/no_locking.hpp>
+#include <boost/flyweight/no_tracking.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Policies for boost::flyweight beyond the default one.
+// The default flyweight<string> keeps all values in one hashed factory
+// behind one global mutex and counts references on every copy and
+// destruction. The policies below take those costs away one by one;
+// each flyweight type has its own factory, so the variants don't mix.
+
+namespace flyweight_detail {
+
+/// hash and equality of factory entries by their key
+template<typename Entry, typename Key> struct key_hash
+{
+  std::size_t operator()(const Entry &entry) const { return std::hash<Key>{}(static_cast<const Key &>(entry)); }
+};
+
+template<typename Entry, typename Key> struct key_equal
+{
+  bool operator()(const Entry &lhs, const Entry &rhs) const
+  {
+    return static_cast<const Key &>(lhs) == static_cast<const Key &>(rhs);
+  }
+};
+
+}// namespace flyweight_detail
+
+/// every thread interns into a set of its own, so no lock is needed; the
+/// factory object itself is shared (boost keeps a single pointer to it for
+/// the whole process), only its sets are per thread. A value lives as long
+/// as the thread which created it, so flyweights must not outlive it or be
+/// passed to other threads, and erase() would look in the wrong set:
+/// use it with no_locking and no_tracking
+struct thread_local_factory : boost::flyweights::factory_marker
+{
+  template<typename Entry, typename Key> struct apply
+  {
+    class type : public boost::flyweights::factory_marker
+    {
+    public:
+      using handle_type = const Entry *;
+
+      handle_type insert(const Entry &entry) { return &*entries().insert(entry).first; }
+      handle_type insert(Entry &&entry) { return &*entries().insert(std::move(entry)).first; }
+      void erase(handle_type handle) { entries().erase(*handle); }
+
+      static const Entry &entry(handle_type handle) { return *handle; }
+
+    private:
+      using set_type =
+        std::unordered_set<Entry, flyweight_detail::key_hash<Entry, Key>, flyweight_detail::key_equal<Entry, Key>>;
+
+      static set_type &entries()
+      {
+        thread_local set_type local;
+        return local;
+      }
+    };
+  };
+};
+
+/// factory split into Shards hashed sets with a mutex each, so threads
+/// interning different values rarely wait for each other; it does its own
+/// locking, so it goes with no_locking, and with no_tracking, because
+/// refcounted tracking relies on the global lock to erase values
+template<std::size_t Shards = 64> struct sharded_factory : boost::flyweights::factory_marker
+{
+  template<typename Entry, typename Key> struct apply
+  {
+    class type : public boost::flyweights::factory_marker
+    {
+    public:
+      using handle_type = const Entry *;
+
+      handle_type insert(const Entry &entry)
+      {
+        auto &shard = shard_of(entry);
+        std::lock_guard lock{ shard.mtx };
+        return &*shard.entries.insert(entry).first;
+      }
+
+      handle_type insert(Entry &&entry)
+      {
+        auto &shard = shard_of(entry);
+        std::lock_guard lock{ shard.mtx };
+        return &*shard.entries.insert(std::move(entry)).first;
+      }
+
+      void erase(handle_type handle)
+      {
+        auto &shard = shard_of(*handle);
+        std::lock_guard lock{ shard.mtx };
+        shard.entries.erase(*handle);
+      }
+
+      static const Entry &entry(handle_type handle) { return *handle; }
+
+    private:
+      using key_hash = flyweight_detail::key_hash<Entry, Key>;
+
+      struct alignas(64) Shard
+      {
+        std::mutex mtx;
+        std::unordered_set<Entry, key_hash, flyweight_detail::key_equal<Entry, Key>> entries;
+      };
+
+      Shard &shard_of(const Entry &entry)
+      {
+        // upper bits pick the shard, the set's buckets use the lower ones
+        auto hash = static_cast<std::uint64_t>(key_hash{}(entry)) * 0x9e3779b97f4a7c15ULL;
+        return shards[(hash >> 40) % Shards];
+      }
+
+      std::vector<Shard> shards = std::vector<Shard>(Shards);
+    };
+  };
+};
+
+/// User2 with a choice of flyweight policies
+template<typename... Policies> struct BasicUser2
+{
+  boost::flyweight<std::string, Policies...> first_name, last_name;
+
+  BasicUser2(const std::string &first_name, const std::string &last_name)
+    : first_name(first_name), last_name(last_name)
+  {}
+};
+
+using User2 = BasicUser2<>;
+/// no reference counting on copies, values stay until the program ends
+using UntrackedUser2 = BasicUser2<boost::flyweights::no_tracking>;
+/// no lock at all, names are shared only within a thread
+using ThreadLocalUser2 =
+  BasicUser2<boost::flyweights::no_tracking, boost::flyweights::no_locking, thread_local_factory>;
+/// one lock per shard instead of a global one
+using ShardedUser2 = BasicUser2<boost::flyweights::no_tracking, boost::flyweights::no_locking, sharded_factory<>>;
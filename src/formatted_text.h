@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Text with formatting, the production version of the Sentence test case.
+// The text is kept once in one string and formatting is a run-length map:
+// runs[p] are the flags of every character from p up to the next key, so
+// formatting a range costs a couple of map operations no matter how long
+// the range is and characters carry nothing. render() walks the runs once,
+// writing into an output whose size is computed beforehand.
+
+enum text_format : std::uint8_t {
+  plain = 0,
+  capitalize = 1,
+  bold = 2,// rendered as **...**
+  italic = 4,// rendered as _..._
+};
+
+/// copies n bytes from src to dst, with ASCII a-z uppercased and all other bytes as they are
+inline void ascii_upper(const char *src, std::size_t n, char *dst)
+{
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  // c - 'a' moved to the signed range, so a single compare tells if c is within a..z
+  const __m128i shift = _mm_set1_epi8(static_cast<char>(128 - 'a'));
+  const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+  const __m128i flip = _mm_set1_epi8(0x20);
+  for (; i + 16 <= n; i += 16) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i lower = _mm_cmplt_epi8(_mm_add_epi8(chars, shift), limit);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_sub_epi8(chars, _mm_and_si128(lower, flip)));
+  }
+#endif
+  for (; i < n; ++i) {
+    char c = src[i];
+    dst[i] = (c >= 'a' && c <= 'z') ? static_cast<char>(c - 0x20) : c;
+  }
+}
+
+class FormattedText
+{
+public:
+  explicit FormattedText(std::string text) : text{ std::move(text) } { runs[0] = plain; }
+
+  [[nodiscard]] std::string_view str() const { return text; }
+  [[nodiscard]] std::size_t size() const { return text.size(); }
+
+  /// adds flags to the characters of [begin, end)
+  void format(std::size_t begin, std::size_t end, std::uint8_t flags)
+  {
+    update(begin, end, [flags](std::uint8_t old) { return static_cast<std::uint8_t>(old | flags); });
+  }
+
+  /// removes flags from the characters of [begin, end)
+  void clear(std::size_t begin, std::size_t end, std::uint8_t flags)
+  {
+    update(begin, end, [flags](std::uint8_t old) { return static_cast<std::uint8_t>(old & ~flags); });
+  }
+
+  /// adds flags to the index-th word (words are separated by spaces)
+  void format_word(std::size_t index, std::uint8_t flags)
+  {
+    auto [begin, end] = word(index);
+    format(begin, end, flags);
+  }
+
+  /// [begin, end) of the index-th word
+  std::pair<std::size_t, std::size_t> word(std::size_t index)
+  {
+    if (word_starts.empty()) { index_words(); }
+    if (index >= word_starts.size()) { throw std::out_of_range("FormattedText: no such word"); }
+    auto begin = word_starts[index];
+    auto end = text.find(' ', begin);
+    return { begin, end == std::string::npos ? text.size() : end };
+  }
+
+  /// flags of the character at pos
+  [[nodiscard]] std::uint8_t flags_at(std::size_t pos) const { return std::prev(runs.upper_bound(pos))->second; }
+  /// number of runs of equal formatting
+  [[nodiscard]] std::size_t run_count() const { return runs.size(); }
+
+  /// size of render() output
+  [[nodiscard]] std::size_t rendered_size() const
+  {
+    std::size_t size = text.size();
+    std::uint8_t open = plain;
+    for_each_run([&](std::size_t, std::size_t, std::uint8_t flags) {
+      size += markers(open, flags);
+      open = flags;
+    });
+    return size + markers(open, plain);
+  }
+
+  [[nodiscard]] std::string render() const
+  {
+    std::string out(rendered_size(), '\0');
+    char *dst = out.data();
+    std::uint8_t open = plain;
+    for_each_run([&](std::size_t begin, std::size_t end, std::uint8_t flags) {
+      dst = switch_markers(dst, open, flags);
+      open = flags;
+      if (flags & capitalize) {
+        ascii_upper(text.data() + begin, end - begin, dst);
+      } else {
+        std::memcpy(dst, text.data() + begin, end - begin);
+      }
+      dst += end - begin;
+    });
+    switch_markers(dst, open, plain);
+    return out;
+  }
+
+private:
+  template<typename Change> void update(std::size_t begin, std::size_t end, Change change)
+  {
+    end = std::min(end, text.size());
+    if (begin >= end) { return; }
+
+    // split the runs at both ends, so [begin, end) is made of whole runs
+    auto split = [this](std::size_t pos) {
+      auto it = std::prev(runs.upper_bound(pos));
+      return it->first == pos ? it : runs.emplace_hint(std::next(it), pos, it->second);
+    };
+    auto last = end < text.size() ? split(end) : runs.end();
+    auto first = split(begin);
+    for (auto it = first; it != last; ++it) { it->second = change(it->second); }
+
+    // merge runs which ended up with the same flags as their neighbour
+    auto from = first == runs.begin() ? first : std::prev(first);
+    auto to = last == runs.end() ? runs.end() : std::next(last);
+    for (auto it = std::next(from); it != to && it != runs.end();) {
+      it = std::prev(it)->second == it->second ? runs.erase(it) : std::next(it);
+    }
+  }
+
+  // calls fun(begin, end, flags) for every run
+  template<typename Fun> void for_each_run(Fun fun) const
+  {
+    for (auto it = runs.begin(); it != runs.end(); ++it) {
+      auto next = std::next(it);
+      auto end = next == runs.end() ? text.size() : next->first;
+      if (it->first < end) { fun(it->first, end, it->second); }
+    }
+  }
+
+  // bold is the outer marker, italic the inner one, so they always nest
+  static std::size_t markers(std::uint8_t from, std::uint8_t to)
+  {
+    char buf[12];
+    return static_cast<std::size_t>(switch_markers(buf, from, to) - buf);
+  }
+
+  static char *switch_markers(char *dst, std::uint8_t from, std::uint8_t to)
+  {
+    bool bold_changes = (from ^ to) & bold;
+    bool italic_closes = (from & italic) && (bold_changes || !(to & italic));
+    bool italic_opens = (to & italic) && (bold_changes || !(from & italic));
+    if (italic_closes) { *dst++ = '_'; }
+    if (bold_changes && (from & bold)) { *dst++ = '*', *dst++ = '*'; }
+    if (bold_changes && (to & bold)) { *dst++ = '*', *dst++ = '*'; }
+    if (italic_opens) { *dst++ = '_'; }
+    return dst;
+  }
+
+  void index_words()
+  {
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      if (text[i] != ' ' && (i == 0 || text[i - 1] == ' ')) { word_starts.push_back(i); }
+    }
+  }
+
+  std::string text;
+  std::map<std::size_t, std::uint8_t> runs;
+  std::vector<std::size_t> word_starts;// filled on the first word()
+};
@@ -0,0 +1,113 @@
+#include "function_decorator.h"
+
+namespace decorators {
+
+AsyncLog &AsyncLog::instance()
+{
+  static AsyncLog log;
+  return log;
+}
+
+AsyncLog::AsyncLog() : output{ stdout }, drainer{ [this] { run(); } } {}
+
+AsyncLog::~AsyncLog()
+{
+  stop = true;
+  drainer.join();
+  drain();
+}
+
+AsyncLog::Ring &AsyncLog::local_ring()
+{
+  // the ring is shared with the drainer, which writes out what is left after the thread exits
+  struct Owner
+  {
+    std::shared_ptr<Ring> ring;
+    explicit Owner(AsyncLog &log) : ring{ std::make_shared<Ring>() }
+    {
+      std::lock_guard lock{ log.mtx };
+      log.rings.push_back(ring);
+    }
+    ~Owner() { ring->abandoned = true; }
+  };
+  thread_local Owner owner{ *this };
+  return *owner.ring;
+}
+
+void AsyncLog::write(std::string_view line)
+{
+  auto &ring = local_ring();
+  auto head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) == kRingSize) {
+    dropped_lines.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto &slot = ring.lines[head % kRingSize];
+  slot.size = static_cast<std::uint8_t>(std::min(line.size(), sizeof(slot.text)));
+  std::copy_n(line.begin(), slot.size, slot.text);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool AsyncLog::drain()
+{
+  std::lock_guard lock{ mtx };
+  std::string batch;
+  for (auto &ring : rings) {
+    auto tail = ring->tail.load(std::memory_order_relaxed);
+    auto head = ring->head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+      const auto &slot = ring->lines[tail % kRingSize];
+      batch.append(slot.text, slot.size);
+      batch += '\n';
+    }
+    ring->tail.store(tail, std::memory_order_release);
+  }
+  std::erase_if(rings, [](const auto &ring) {
+    return ring->abandoned && ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+  });
+
+  if (batch.empty()) { return false; }
+  std::fwrite(batch.data(), 1, batch.size(), output);
+  std::fflush(output);
+  return true;
+}
+
+void AsyncLog::run()
+{
+  auto idle = std::chrono::microseconds{ 50 };
+  while (!stop) {
+    // a flush request is served by a drain which started after it was made
+    auto requested = flush_requests.load();
+    if (drain()) {
+      idle = std::chrono::microseconds{ 50 };
+    } else {
+      std::this_thread::sleep_for(idle);
+      idle = std::min(idle * 2, std::chrono::microseconds{ 5000 });
+    }
+    flushed = requested;
+    flushed.notify_all();
+  }
+  // requests made while stopping are served by the loop above or by flush() itself
+  flushed = flush_requests.load();
+  flushed.notify_all();
+}
+
+void AsyncLog::flush()
+{
+  auto ticket = flush_requests.fetch_add(1) + 1;
+  if (stop) {
+    // the drainer is gone or about to go, nobody else would write the lines out
+    drain();
+    return;
+  }
+  for (auto done = flushed.load(); done < ticket; done = flushed.load()) { flushed.wait(done); }
+}
+
+void AsyncLog::set_output(std::FILE *file)
+{
+  std::lock_guard lock{ mtx };
+  output = file;
+}
+
+}// namespace decorators
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "concurrent_cache.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Function decorators without type erasure.
+// A decorator is any object callable as d(next, args...), which does its
+// work around `return next(std::forward<Args>(args)...)`. decorate(f, d1, d2)
+// keeps f and the decorators by value and chains them with lambdas known at
+// compile time, so the whole stack is inlined into a single call: arguments
+// are forwarded untouched (move-only ones too) and decltype(auto) keeps
+// void and reference results as they are.
+namespace decorators {
+
+template<typename F, typename... Decorators> class decorated
+{
+public:
+  explicit decorated(F func, Decorators... decos) : func{ std::move(func) }, decos{ std::move(decos)... } {}
+
+  template<typename... Args> decltype(auto) operator()(Args &&...args)
+  {
+    return call<0>(std::forward<Args>(args)...);
+  }
+
+  /// the I-th decorator, to read its statistics
+  template<std::size_t I> auto &get() { return std::get<I>(decos); }
+
+private:
+  template<std::size_t I, typename... Args> decltype(auto) call(Args &&...args)
+  {
+    if constexpr (I == sizeof...(Decorators)) {
+      return std::invoke(func, std::forward<Args>(args)...);
+    } else {
+      return std::get<I>(decos)(
+        [this](auto &&...rest) -> decltype(auto) { return call<I + 1>(std::forward<decltype(rest)>(rest)...); },
+        std::forward<Args>(args)...);
+    }
+  }
+
+  F func;
+  std::tuple<Decorators...> decos;
+};
+
+/// the first decorator is the outermost one
+template<typename F, typename... Decorators> auto decorate(F &&func, Decorators &&...decos)
+{
+  return decorated<std::decay_t<F>, std::decay_t<Decorators>...>{ std::forward<F>(func),
+    std::forward<Decorators>(decos)... };
+}
+
+/// runs an action when the scope is left, so decorators can act after
+/// `return next(...)` whatever it returns (also when it throws)
+template<typename F> struct on_exit
+{
+  F action;
+  ~on_exit() { action(); }
+};
+template<typename F> on_exit(F) -> on_exit<F>;
+
+// ---- log written by a background thread
+
+/// Every thread writes its log lines into its own ring buffer (a single
+/// producer, single consumer queue, so no locks and no waiting: a line that
+/// doesn't fit is dropped and counted). A background thread drains all
+/// rings and writes to the output with one call per batch.
+class AsyncLog
+{
+public:
+  static constexpr std::size_t kLineSize = 64;// longer lines are cut
+  static constexpr std::size_t kRingSize = 4096;// lines per thread
+
+  static AsyncLog &instance();
+
+  /// queues a line (without '\n') for writing, never blocks
+  void write(std::string_view line);
+  /// waits until everything written so far is on the output
+  void flush();
+
+  /// where lines go, stdout by default
+  void set_output(std::FILE *file);
+  [[nodiscard]] std::uint64_t dropped() const { return dropped_lines.load(std::memory_order_relaxed); }
+
+  ~AsyncLog();
+
+private:
+  struct Line
+  {
+    std::uint8_t size;
+    char text[kLineSize - 1];
+  };
+
+  struct Ring
+  {
+    alignas(64) std::atomic<std::size_t> head{ 0 };// next slot to write, owned by the producer
+    alignas(64) std::atomic<std::size_t> tail{ 0 };// next slot to read, owned by the drainer
+    std::atomic<bool> abandoned{ false };// the thread is gone, drop the ring once empty
+    std::array<Line, kRingSize> lines;
+  };
+
+  AsyncLog();
+  Ring &local_ring();
+  bool drain();
+  void run();
+
+  std::mutex mtx;// guards rings and output
+  std::vector<std::shared_ptr<Ring>> rings;
+  std::FILE *output;
+  std::atomic<std::uint64_t> dropped_lines{ 0 };
+  std::atomic<std::uint64_t> flush_requests{ 0 };
+  std::atomic<std::uint64_t> flushed{ 0 };
+  std::atomic<bool> stop{ false };
+  std::thread drainer;
+};
+
+// ---- decorators
+
+struct call_stats
+{
+  std::atomic<std::uint64_t> calls{ 0 };
+  std::atomic<std::uint64_t> nanoseconds{ 0 };
+};
+
+/// counts calls
+struct counting
+{
+  call_stats *stats;
+
+  template<typename Next, typename... Args> decltype(auto) operator()(Next &&next, Args &&...args)
+  {
+    stats->calls.fetch_add(1, std::memory_order_relaxed);
+    return next(std::forward<Args>(args)...);
+  }
+};
+
+/// adds the time spent in the call to stats
+struct timing
+{
+  call_stats *stats;
+
+  template<typename Next, typename... Args> decltype(auto) operator()(Next &&next, Args &&...args)
+  {
+    on_exit done{ [this, start = std::chrono::steady_clock::now()] {
+      auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      stats->nanoseconds.fetch_add(static_cast<std::uint64_t>(took.count()), std::memory_order_relaxed);
+    } };
+    return next(std::forward<Args>(args)...);
+  }
+};
+
+/// logs entering and exiting every n-th call into the AsyncLog, nothing if n is 0
+struct logging
+{
+  std::string name;
+  std::uint32_t every = 1;
+  std::atomic<std::uint32_t> calls{ 0 };
+
+  explicit logging(std::string name, std::uint32_t every = 1) : name{ std::move(name) }, every{ every } {}
+  logging(const logging &other) : name{ other.name }, every{ other.every } {}
+
+  template<typename Next, typename... Args> decltype(auto) operator()(Next &&next, Args &&...args)
+  {
+    if (every == 0 || calls.fetch_add(1, std::memory_order_relaxed) % every != 0) {
+      return next(std::forward<Args>(args)...);
+    }
+
+    line("Entering ");
+    on_exit done{ [this] { line("Exiting "); } };
+    return next(std::forward<Args>(args)...);
+  }
+
+private:
+  void line(std::string_view what) const
+  {
+    char buf[AsyncLog::kLineSize];
+    auto size = std::min(what.size() + name.size(), sizeof(buf));
+    std::copy(what.begin(), what.end(), buf);
+    std::copy_n(name.begin(), size - what.size(), buf + what.size());
+    AsyncLog::instance().write({ buf, size });
+  }
+};
+
+/// hash of a tuple of hashable values
+struct tuple_hash
+{
+  template<typename... Ts> std::size_t operator()(const std::tuple<Ts...> &values) const
+  {
+    return std::apply(
+      [](const auto &...parts) {
+        std::size_t seed = 0;
+        ((seed ^= std::hash<std::decay_t<decltype(parts)>>{}(parts) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)),
+          ...);
+        return seed;
+      },
+      values);
+  }
+};
+
+/// remembers results by arguments (which have to be hashable and equality
+/// comparable), not synchronized: a caching stack is for one thread
+template<typename> struct caching;
+
+template<typename R, typename... Args> struct caching<R(Args...)>
+{
+  static_assert(!std::is_void_v<R>, "there is nothing to cache for void functions");
+
+  using key = std::tuple<std::decay_t<Args>...>;
+
+  std::unordered_map<key, std::decay_t<R>, tuple_hash> results;
+
+  template<typename Next, typename... CallArgs> std::decay_t<R> operator()(Next &&next, CallArgs &&...args)
+  {
+    key k{ args... };
+    if (auto it = results.find(k); it != results.end()) { return it->second; }
+    return results.emplace(std::move(k), next(std::forward<CallArgs>(args)...)).first->second;
+  }
+};
+
+/// like caching, but bounded and safe to call from many threads, see ConcurrentCache;
+/// copies share the cache
+template<typename, typename Eviction = eviction::lru> struct memoizing;
+
+template<typename R, typename... Args, typename Eviction> struct memoizing<R(Args...), Eviction>
+{
+  static_assert(!std::is_void_v<R>, "there is nothing to cache for void functions");
+
+  using cache_type = ConcurrentCache<std::tuple<std::decay_t<Args>...>, std::decay_t<R>, tuple_hash, Eviction>;
+
+  std::shared_ptr<cache_type> cache;
+
+  explicit memoizing(std::size_t capacity, std::size_t shards = cache_type::default_shards())
+    : cache{ std::make_shared<cache_type>(capacity, shards) }
+  {}
+
+  template<typename Next, typename... CallArgs> std::decay_t<R> operator()(Next &&next, CallArgs &&...args)
+  {
+    return cache->get_or_compute(
+      typename cache_type::key_type{ args... }, [&] { return next(std::forward<CallArgs>(args)...); });
+  }
+
+  [[nodiscard]] cache_stats stats() const { return cache->stats(); }
+};
+
+/// func with its results kept in a bounded concurrent cache,
+/// the memoizing decorator is get<0>() of the result
+template<typename R, typename... Args, typename Eviction = eviction::lru>
+auto make_memoized(R (*func)(Args...), std::size_t capacity, Eviction /*policy*/ = {})
+{
+  return decorate(func, memoizing<R(Args...), Eviction>{ capacity });
+}
+
+/// the same for any callable, its signature is given explicitly: make_memoized<int(int)>(f, 100)
+template<typename Signature, typename F, typename Eviction = eviction::lru>
+auto make_memoized(F &&func, std::size_t capacity, Eviction /*policy*/ = {})
+{
+  return decorate(std::forward<F>(func), memoizing<Signature, Eviction>{ capacity });
+}
+
+}// namespace decorators
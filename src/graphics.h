@@ -0,0 +1,31 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct GraphicObject
+{
+  virtual ~GraphicObject() = default;
+  virtual void draw() = 0;
+};
+
+struct Circle : GraphicObject
+{
+  void draw() override { std::cout << "Circle\n"; }
+};
+
+struct Group : GraphicObject
+{
+  std::string name;
+
+  explicit Group(const std::string &name) : name{ name } {}
+
+  void draw() override
+  {
+    std::cout << "Group " << name << " contains:\n";
+    for (auto &&o : objects) o->draw();
+  }
+
+  std::vector<GraphicObject *> objects;
+};
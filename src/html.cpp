@@ -0,0 +1,183 @@
+#include "html.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <system_error>
+#include <unistd.h>
+#endif
+
+std::string_view HtmlArena::intern(std::string_view name)
+{
+  auto it = names.find(name);
+  if (it != names.end()) { return *it; }
+  return *names.insert(copy(name)).first;
+}
+
+std::string_view HtmlArena::copy(std::string_view text)
+{
+  if (text.empty()) { return {}; }
+  auto *buf = static_cast<char *>(memory.allocate(text.size(), 1));
+  std::memcpy(buf, text.data(), text.size());
+  return { buf, text.size() };
+}
+
+HtmlNode *HtmlArena::make(std::string_view name, std::string_view text)
+{
+  auto *node = static_cast<HtmlNode *>(memory.allocate(sizeof(HtmlNode), alignof(HtmlNode)));
+  return new (node) HtmlNode{ intern(name), copy(text) };
+}
+
+HtmlNode *HtmlArena::append(HtmlNode *parent, std::string_view name, std::string_view text)
+{
+  auto *node = make(name, text);
+  if (parent->last_child) {
+    parent->last_child->next = node;
+  } else {
+    parent->first_child = node;
+  }
+  parent->last_child = node;
+  return node;
+}
+
+namespace {
+
+// visits the tree without recursion, so deep documents don't exhaust the stack,
+// emit() gets the pieces of the document in order
+template<typename Emit> void walk(const HtmlNode &root, Emit &&emit)
+{
+  struct Frame
+  {
+    const HtmlNode *node;
+    const HtmlNode *child;
+  };
+  std::vector<Frame> stack;
+
+  auto open = [&](const HtmlNode *node) {
+    emit(std::string_view{ "<" });
+    emit(node->name);
+    emit(std::string_view{ ">" });
+    emit(node->text.empty() ? std::string_view{ "\n" } : node->text);
+    stack.push_back({ node, node->first_child });
+  };
+
+  open(&root);
+  while (!stack.empty()) {
+    auto &top = stack.back();
+    if (top.child) {
+      const auto *child = top.child;
+      top.child = child->next;
+      open(child);
+    } else {
+      emit(std::string_view{ "</" });
+      emit(top.node->name);
+      emit(std::string_view{ ">\n" });
+      stack.pop_back();
+    }
+  }
+}
+
+}// namespace
+
+std::size_t rendered_size(const HtmlNode &root)
+{
+  std::size_t size = 0;
+  walk(root, [&size](std::string_view piece) { size += piece.size(); });
+  return size;
+}
+
+std::string render_html(const HtmlNode &root)
+{
+  std::string out(rendered_size(root), '\0');
+  char *at = out.data();
+  walk(root, [&at](std::string_view piece) {
+    if (piece.empty()) { return; }
+    std::memcpy(at, piece.data(), piece.size());
+    at += piece.size();
+  });
+  return out;
+}
+
+void render_html(const HtmlNode &root, std::vector<std::string_view> &pieces)
+{
+  walk(root, [&pieces](std::string_view piece) { pieces.push_back(piece); });
+}
+
+#ifndef _WIN32
+
+namespace {
+[[noreturn]] void throw_errno(const char *what) { throw std::system_error(errno, std::generic_category(), what); }
+}// namespace
+
+void FdSink::write(std::string_view data)
+{
+  while (!data.empty()) {
+    auto done = ::write(fd, data.data(), data.size());
+    if (done < 0) {
+      if (errno == EINTR) { continue; }
+      throw_errno("FdSink::write");
+    }
+    data.remove_prefix(static_cast<std::size_t>(done));
+  }
+}
+
+MappedFileSink::MappedFileSink(const std::string &path, std::size_t window)
+{
+  // windows must start at page boundaries
+  auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  this->window = std::max(page, (window + page - 1) / page * page);
+
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { throw_errno("MappedFileSink: open"); }
+}
+
+MappedFileSink::~MappedFileSink()
+{
+  try {
+    close();
+  } catch (...) {
+    // nothing to do in a destructor, call close() to see errors
+  }
+}
+
+void MappedFileSink::map_next()
+{
+  if (mapped) { ::munmap(mapped, window); }
+  mapped = nullptr;
+  mapped_from = offset;
+  if (::ftruncate(fd, static_cast<off_t>(mapped_from + window)) != 0) { throw_errno("MappedFileSink: ftruncate"); }
+  void *addr = ::mmap(nullptr, window, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(mapped_from));
+  if (addr == MAP_FAILED) { throw_errno("MappedFileSink: mmap"); }
+  mapped = static_cast<char *>(addr);
+}
+
+void MappedFileSink::write(std::string_view data)
+{
+  while (!data.empty()) {
+    if (!mapped || offset == mapped_from + window) { map_next(); }
+    auto room = mapped_from + window - offset;
+    auto part = std::min(room, data.size());
+    std::memcpy(mapped + (offset - mapped_from), data.data(), part);
+    offset += part;
+    data.remove_prefix(part);
+  }
+}
+
+void MappedFileSink::close()
+{
+  if (fd < 0) { return; }
+  if (mapped) {
+    ::munmap(mapped, window);
+    mapped = nullptr;
+  }
+  int res = ::ftruncate(fd, static_cast<off_t>(offset));
+  ::close(fd);
+  fd = -1;
+  if (res != 0) { throw_errno("MappedFileSink: ftruncate"); }
+}
+
+#endif
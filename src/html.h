@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// simple builder
+struct HtmlElement
+{
+  std::string name;
+  std::string text;
+  std::vector<HtmlElement> elements;
+
+  HtmlElement() = default;
+  HtmlElement(std::string name, std::string text) : name(std::move(name)), text(std::move(text)) {}
+
+  void str(int indent = 0) const
+  {
+    for (int i = 0; i < indent; ++i) { std::cout << " "; }
+    std::cout << "<" << name << ">";
+    if (text.empty()) {
+      std::cout << std::endl;
+    } else {
+      std::cout << text;
+    }
+    for (const auto &element : elements) { element.str(indent); }
+    std::cout << "</" << name << ">" << std::endl;
+  }
+};
+
+struct SimpleHtmlBuilder
+{
+  HtmlElement root;
+  explicit SimpleHtmlBuilder(std::string root_name) { root.name = std::move(root_name); }
+
+  // allows call add_child in a chain
+  SimpleHtmlBuilder &add_child(std::string child_name, std::string child_text)
+  {
+    root.elements.emplace_back(std::move(child_name), std::move(child_text));
+    return *this;
+  }
+
+  void str() const { root.str(); }
+};
+
+
+// DSL styled
+struct Tag
+{
+  std::string name;
+  std::string text;
+  std::vector<Tag> children;
+  std::vector<std::pair<std::string, std::string>> attributes;
+
+  friend std::ostream &operator<<(std::ostream &ost, const Tag &tag)
+  {
+    ost << "<" << tag.name;
+    if (!tag.attributes.empty()) {
+      ost << " ";
+      for (const auto &pair : tag.attributes) { ost << pair.first << "=\"" << pair.second << "\""; }
+    }
+    ost << ">";
+    if (tag.text.empty()) {
+      ost << std::endl;
+    } else {
+      ost << tag.text;
+    }
+    for (const auto &element : tag.children) { ost << element; }
+    ost << "</" << tag.name << ">" << std::endl;
+    return ost;
+  }
+
+protected:
+  Tag(std::string name, std::string text) : name(std::move(name)), text(std::move(text)) {}
+  Tag(std::string name, std::vector<Tag> children) : name(std::move(name)), children(std::move(children)) {}
+};
+
+struct P : Tag
+{
+  explicit P(const std::string &text) : Tag("P", text) {}
+
+  P(std::initializer_list<Tag> children) : Tag("P", children) {}
+};
+
+struct IMG : Tag
+{
+  explicit IMG(const std::string &url) : Tag("IMG", "") { attributes.emplace_back("src", url); }
+};
+
+// ----- arena backed builder ------
+//
+// HtmlElement owns its strings and a vector of children, so a big document
+// is millions of small allocations, and str() does an iostream call per piece.
+// Here all nodes and texts live in one monotonic arena (freed at once),
+// tag names are interned and children are linked in place.
+// Rendering measures the document first and then writes it into a single
+// buffer of the exact size, the output is the same as HtmlElement::str() gives.
+
+struct HtmlNode
+{
+  std::string_view name;
+  std::string_view text;
+  HtmlNode *first_child = nullptr;
+  HtmlNode *last_child = nullptr;
+  HtmlNode *next = nullptr;
+};
+
+class HtmlArena
+{
+public:
+  explicit HtmlArena(std::size_t initial_bytes = 64 * 1024) : memory(initial_bytes) {}
+
+  HtmlArena(const HtmlArena &) = delete;
+  HtmlArena &operator=(const HtmlArena &) = delete;
+
+  /// one copy per distinct tag name
+  std::string_view intern(std::string_view name);
+  std::string_view copy(std::string_view text);
+
+  HtmlNode *make(std::string_view name, std::string_view text);
+  /// creates a node and appends it to the children of parent
+  HtmlNode *append(HtmlNode *parent, std::string_view name, std::string_view text);
+
+private:
+  std::pmr::monotonic_buffer_resource memory;
+  std::pmr::unordered_set<std::string_view> names{ &memory };
+};
+
+/// exact number of bytes render_html() produces
+std::size_t rendered_size(const HtmlNode &root);
+/// renders the tree with one allocation
+std::string render_html(const HtmlNode &root);
+/// appends views of all pieces of the document (writev-style gather list),
+/// nothing is copied, views point into the arena or to static strings
+void render_html(const HtmlNode &root, std::vector<std::string_view> &pieces);
+
+struct ArenaHtmlBuilder
+{
+  HtmlArena arena;
+  HtmlNode *root;
+
+  explicit ArenaHtmlBuilder(std::string_view root_name) : root(arena.make(root_name, {})) {}
+
+  // allows call add_child in a chain
+  ArenaHtmlBuilder &add_child(std::string_view child_name, std::string_view child_text)
+  {
+    arena.append(root, child_name, child_text);
+    return *this;
+  }
+
+  [[nodiscard]] std::string str() const { return render_html(*root); }
+};
+
+// ----- streaming builder ------
+//
+// Both builders above keep the whole document in memory until it is rendered.
+// StreamingHtmlBuilder writes every tag as soon as it is known and keeps only
+// the names of currently open elements, so memory is O(depth) no matter how
+// big the document is. Output goes through a buffer which is handed over to
+// the sink when it reaches the flush threshold.
+// A sink is anything with a write(std::string_view) member.
+
+template<typename Sink> class StreamingHtmlBuilder
+{
+public:
+  static constexpr std::size_t kDefaultFlushThreshold = 64 * 1024;
+
+  StreamingHtmlBuilder(Sink &sink, std::string_view root_name, std::size_t flush_threshold = kDefaultFlushThreshold)
+    : sink(sink), threshold(flush_threshold)
+  {
+    buffer.reserve(threshold);
+    open(root_name);
+  }
+
+  ~StreamingHtmlBuilder()
+  {
+    try {
+      finish();
+    } catch (...) {
+      // sinks throw on I/O errors, call finish() to see them
+    }
+  }
+
+  StreamingHtmlBuilder(const StreamingHtmlBuilder &) = delete;
+  StreamingHtmlBuilder &operator=(const StreamingHtmlBuilder &) = delete;
+
+  // allows call add_child in a chain, the child is written out immediately
+  StreamingHtmlBuilder &add_child(std::string_view child_name, std::string_view child_text)
+  {
+    put("<", child_name, ">");
+    put(child_text.empty() ? std::string_view{ "\n" } : child_text);
+    put("</", child_name, ">\n");
+    return *this;
+  }
+
+  /// opens an element, following children go into it until close()
+  StreamingHtmlBuilder &open(std::string_view name, std::string_view text = {})
+  {
+    put("<", name, ">");
+    put(text.empty() ? std::string_view{ "\n" } : text);
+    open_elements.emplace_back(name);
+    return *this;
+  }
+
+  StreamingHtmlBuilder &close()
+  {
+    if (!open_elements.empty()) {
+      put("</", open_elements.back(), ">\n");
+      open_elements.pop_back();
+    }
+    return *this;
+  }
+
+  /// closes all open elements and flushes, nothing can be added afterwards;
+  /// errors of the sink are thrown from here but not from the destructor
+  void finish()
+  {
+    while (!open_elements.empty()) { close(); }
+    finished = true;
+    flush();
+  }
+
+  void flush()
+  {
+    if (!buffer.empty()) {
+      sink.write(buffer);
+      buffer.clear();
+    }
+  }
+
+  [[nodiscard]] std::size_t depth() const { return open_elements.size(); }
+  /// bytes held by the builder, stays around the flush threshold
+  [[nodiscard]] std::size_t buffered_capacity() const { return buffer.capacity(); }
+
+private:
+  template<typename... Pieces> void put(Pieces... pieces)
+  {
+    if (finished) { throw std::logic_error("StreamingHtmlBuilder: the document is already finished"); }
+    std::size_t size = (std::string_view{ pieces }.size() + ...);
+    if (buffer.size() + size > threshold) { flush(); }
+    if (size > threshold) {
+      // too big to be buffered, goes to the sink as is
+      (sink.write(std::string_view{ pieces }), ...);
+      return;
+    }
+    (buffer.append(std::string_view{ pieces }), ...);
+  }
+
+  Sink &sink;
+  std::size_t threshold;
+  std::string buffer;
+  std::vector<std::string> open_elements;
+  bool finished = false;
+};
+
+#ifndef _WIN32
+
+/// writes straight to a file descriptor (a file, a pipe, a socket),
+/// the descriptor isn't closed by the sink
+class FdSink
+{
+public:
+  explicit FdSink(int fd) : fd(fd) {}
+
+  void write(std::string_view data);
+
+private:
+  int fd;
+};
+
+/// writes into a file through a memory mapping: the file is grown and
+/// mapped window by window, data is copied from the builder buffer right
+/// into the page cache without any write() calls.
+/// The file is truncated to the written size on close().
+class MappedFileSink
+{
+public:
+  static constexpr std::size_t kDefaultWindow = 64 * 1024 * 1024;
+
+  explicit MappedFileSink(const std::string &path, std::size_t window = kDefaultWindow);
+  ~MappedFileSink();
+
+  MappedFileSink(const MappedFileSink &) = delete;
+  MappedFileSink &operator=(const MappedFileSink &) = delete;
+
+  void write(std::string_view data);
+  void close();
+
+  [[nodiscard]] std::size_t written() const { return offset; }
+
+private:
+  void map_next();
+
+  int fd = -1;
+  std::size_t window;
+  char *mapped = nullptr;
+  std::size_t mapped_from = 0;// file offset of the window
+  std::size_t offset = 0;// bytes written so far
+};
+
+#endif
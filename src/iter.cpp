@@ -1,117 +1,28 @@
+#include "iter.h"
+#include "arena_tree.h"
+#include "binary_tree.h"
 #include <iostream>
 #include <string>
+#include <vector>
 
-#include "recursive_generator.h"
-
-template<typename T> struct BinaryTree;
-
-template<typename T> struct Node
-{
-  T value;
-  Node<T> *left = nullptr;
-  Node<T> *right = nullptr;
-  Node<T> *parent = nullptr;
-  BinaryTree<T> *tree = nullptr;
-
-  // constructors
-
-  explicit Node(const T &value) : value(value) {}
-
-  Node(const T &value, Node<T> *const left, Node<T> *const right)
-    : value(value), left(left), right(right)
-  {
-    this->left->tree = this->right->tree = tree;
-    this->left->parent = this->right->parent = this;
-  }
-
-  void set_tree(BinaryTree<T> *t)
-  {
-    tree = t;
-    if (left) left->set_tree(t);
-    if (right) right->set_tree(t);
-  }
-};
-
-template<typename U> struct PreOrderIterator
-{
-  Node<U> *current;
-
-  explicit PreOrderIterator(Node<U> *current) : current(current) {}
-
-  bool operator!=(const PreOrderIterator<U> &other)
-  {
-    return current != other.current;
-  }
-
-  Node<U> &operator*() { return *current; }
-
-  PreOrderIterator<U> &operator++()
-  {
-    if (current->right) {
-      current = current->right;
-      while (current->left) { current = current->left; }
-    } else {
-      Node<U> *p = current->parent;
-      while (p && current == p->right) {
-        current = p;
-        p = p->parent;
-      }
-      current = p;
-    }
-    return *this;
-  }
-};
-
-template<typename T> struct BinaryTree
+// same family in one vector, children are added before their parents
+void arena_tree_examples()
 {
-  Node<T> *root = nullptr;
-
-  explicit BinaryTree(Node<T> *const root) : root(root)
-  {
-    root->set_tree(this);
-  }
-
-  typedef PreOrderIterator<T> iterator;
+  ArenaTree<std::string> family;
+  auto mother = family.add("mother", family.add("mother's mother"), family.add("mother's father"));
+  family.add("me", mother, family.add("father"));
 
-  iterator begin()
-  {
-    Node<T> *n = root;
+  std::cout << "in order again, with an index based tree:\n";
+  for (const auto &name : family) { std::cout << name << "\n"; }
 
-    if (n) {
-      while (n->left) { n = n->left; }
-    }
-    return iterator{ n };
+  std::vector<int> sorted{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  for (auto layout : { tree_layout::eytzinger, tree_layout::van_emde_boas }) {
+    auto numbers = ArenaTree<int>::from_sorted(sorted, layout);
+    std::cout << (layout == tree_layout::eytzinger ? "Eytzinger" : "van Emde Boas") << " layout:";
+    for (ArenaTree<int>::index i = 0; i < numbers.size(); ++i) { std::cout << " " << numbers[i].value; }
+    std::cout << ", 7 is node " << numbers.find(7) << "\n";
   }
-
-  iterator end() { return iterator{ nullptr }; }
-
-  class pre_order_traversal
-  {
-    BinaryTree<T> &tree;
-
-  public:
-    pre_order_traversal(BinaryTree<T> &tree) : tree{ tree } {}
-    iterator begin() { return tree.begin(); }
-    iterator end() { return tree.end(); }
-  } pre_order { *this };
-
-  recursive_generator<Node<T> *> post_order()
-  {
-    return post_order_impl(root);
-  }
-
-  private:
-    recursive_generator<Node<T> *> post_order_impl(Node<T> *node)
-    {
-      if (node) {
-        for (auto x : post_order_impl(node->left)) co_yield x;
-
-        for (auto y : post_order_impl(node->right)) co_yield y;
-        co_yield node;
-      }
-    }
-};
-
+}
 
 void run_iterator_examples()
 {
@@ -136,4 +47,6 @@ void run_iterator_examples()
   std::cout << "same with coroutines:\n";
 
   for (auto it : family.post_order()) { std::cout << it->value << "\n"; }
-}
\ No newline at end of file
+
+  arena_tree_examples();
+}
@@ -1,4 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 // composite is like a proxy too
-void run_iterator_examples();
\ No newline at end of file
+void run_iterator_examples();
+void run_iterator_benchmarks(std::size_t limit);
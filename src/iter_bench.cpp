@@ -0,0 +1,387 @@
+#include "arena_tree.h"
+#include "bench.h"
+#include "binary_tree.h"
+#include "iter.h"
+#include <algorithm>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kResumingDepth = 10'000;
+
+using Tree = ArenaTree<std::uint32_t>;
+
+// balanced search tree of keys[first, last) made of heap nodes
+Node<std::uint32_t> *make_nodes(const std::vector<std::uint32_t> &keys, std::size_t first, std::size_t last)
+{
+  if (first == last) { return nullptr; }
+  auto middle = first + (last - first) / 2;
+  auto *left = make_nodes(keys, first, middle);
+  auto *right = make_nodes(keys, middle + 1, last);
+  return new Node<std::uint32_t>{ keys[middle], left, right };
+}
+
+// the same tree added bottom up, the way a tree is built without knowing its layout
+Tree::index add_nodes(Tree &tree, const std::vector<std::uint32_t> &keys, std::size_t first, std::size_t last)
+{
+  if (first == last) { return Tree::none; }
+  auto middle = first + (last - first) / 2;
+  auto left = add_nodes(tree, keys, first, middle);
+  auto right = add_nodes(tree, keys, middle + 1, last);
+  return tree.add(keys[middle], left, right);
+}
+
+// a tree leaning to the left: every left subtree has 9/10 of the nodes
+Node<std::uint32_t> *make_skewed(const std::vector<std::uint32_t> &keys, std::size_t first, std::size_t last)
+{
+  if (first == last) { return nullptr; }
+  auto middle = first + (last - first - 1) * 9 / 10;
+  auto *left = make_skewed(keys, first, middle);
+  auto *right = make_skewed(keys, middle + 1, last);
+  return new Node<std::uint32_t>{ keys[middle], left, right };
+}
+
+// post_order() as it was: every value is yielded again by each generator above it
+recursive_generator<Node<std::uint32_t> *> post_order_reyielding(Node<std::uint32_t> *node)
+{
+  if (node) {
+    for (auto x : post_order_reyielding(node->left)) co_yield x;
+    for (auto y : post_order_reyielding(node->right)) co_yield y;
+    co_yield node;
+  }
+}
+
+bool contains(const BinaryTree<std::uint32_t> &tree, std::uint32_t key)
+{
+  for (auto *node = tree.root; node;) {
+    if (key < node->value) {
+      node = node->left;
+    } else if (node->value < key) {
+      node = node->right;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+void bench_trees(std::size_t count)
+{
+  std::cout << "--- binary search trees of " << count << " nodes ---\n";
+  std::vector<std::uint32_t> keys(count);
+  for (std::size_t i = 0; i < count; ++i) { keys[i] = static_cast<std::uint32_t>(2 * i); }
+  // half of the lookups miss
+  std::vector<std::uint32_t> lookups(std::min<std::size_t>(count, 1'000'000));
+  std::mt19937 rng{ 42 };
+  std::uniform_int_distribution<std::uint32_t> any_key{ 0, static_cast<std::uint32_t>(2 * count) };
+  for (auto &key : lookups) { key = any_key(rng); }
+
+  BinaryTree<std::uint32_t> pointers{ nullptr };
+  bench::report("build: heap nodes", count, bench::measure_ms([&] { pointers.root = make_nodes(keys, 0, count); }, 1));
+  pointers.root->set_tree(&pointers);
+  Tree built;
+  bench::report("build: ArenaTree::add", count, bench::measure_ms([&] {
+    built.reserve(count);
+    add_nodes(built, keys, 0, count);
+  }, 1));
+  Tree eytzinger;
+  bench::report("build: ArenaTree::from_sorted", count, bench::measure_ms([&] {
+    eytzinger = Tree::from_sorted(keys);
+  }, 1));
+  Tree veb;
+  bench::report("relayout: van Emde Boas", count, bench::measure_ms([&] {
+    veb = built.relayout(tree_layout::van_emde_boas);
+  }, 1));
+  auto depth_first = built.relayout(tree_layout::depth_first);
+
+  bench::report("in order: PreOrderIterator", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto it = pointers.begin(); it != pointers.end(); ++it) { sum += (*it).value; }
+    bench::keep(sum);
+  }));
+  const std::pair<const char *, const Tree *> arenas[] = {
+    { "as built", &built }, { "depth first", &depth_first }, { "Eytzinger", &eytzinger }, { "van Emde Boas", &veb }
+  };
+  for (auto [name, tree] : arenas) {
+    bench::report(std::string{ "in order: ArenaTree, " } + name, count, bench::measure_ms([&] {
+      std::uint64_t sum = 0;
+      for (auto key : *tree) { sum += key; }
+      bench::keep(sum);
+    }));
+  }
+
+  bench::report("lookup: heap nodes", lookups.size(), bench::measure_ms([&] {
+    std::size_t found = 0;
+    for (auto key : lookups) { found += contains(pointers, key); }
+    bench::keep(found);
+  }));
+  for (auto [name, tree] : arenas) {
+    bench::report(std::string{ "lookup: ArenaTree, " } + name, lookups.size(), bench::measure_ms([&] {
+      std::size_t found = 0;
+      for (auto key : lookups) { found += tree->find(key) != Tree::none; }
+      bench::keep(found);
+    }));
+  }
+}
+
+void bench_parallel(std::size_t count)
+{
+  std::cout << "--- parallel traversal of " << count << " nodes ---\n";
+  std::vector<std::uint32_t> keys(count);
+  for (std::size_t i = 0; i < count; ++i) { keys[i] = static_cast<std::uint32_t>(i); }
+  BinaryTree<std::uint32_t> tree{ make_nodes(keys, 0, count) };
+
+  bench::report("sum: PreOrderIterator", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++it) { sum += (*it).value; }
+    bench::keep(sum);
+  }));
+
+  // 1, 2, 4, ... workers up to the number of cores
+  std::vector<std::size_t> workers;
+  const std::size_t cores = std::max(1U, std::thread::hardware_concurrency());
+  for (std::size_t threads = 1; threads < cores; threads *= 2) { workers.push_back(threads); }
+  workers.push_back(cores);
+
+  std::vector<std::uint32_t> ordered(count);
+  for (auto threads : workers) {
+    ThreadPool pool{ threads };
+    auto suffix = " x" + std::to_string(threads);
+    bench::report("parallel_reduce: sum" + suffix, count, bench::measure_ms([&] {
+      bench::keep(tree.parallel_reduce(tree_order::in_order, std::uint64_t{ 0 },
+        [](const Node<std::uint32_t> &node) -> std::uint64_t { return node.value; }, std::plus<>{}, pool));
+    }));
+    bench::report("parallel_reduce: count_if" + suffix, count, bench::measure_ms([&] {
+      bench::keep(tree.parallel_reduce(tree_order::post_order, std::size_t{ 0 },
+        [](const Node<std::uint32_t> &node) -> std::size_t { return node.value % 3 == 0; }, std::plus<>{}, pool));
+    }));
+    bench::report("parallel_for_each: to array" + suffix, count, bench::measure_ms([&] {
+      tree.parallel_for_each(tree_order::pre_order,
+        [&ordered](Node<std::uint32_t> &node, std::size_t at) { ordered[at] = node.value; }, pool);
+      bench::keep(ordered.data());
+    }));
+  }
+}
+
+recursive_generator<std::uint32_t> one_by_one(std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i) { co_yield static_cast<std::uint32_t>(i); }
+}
+
+recursive_generator<std::uint32_t> in_batches(std::size_t count)
+{
+  constexpr std::size_t kBatch = 4096;
+  std::vector<std::uint32_t> buffer(kBatch);
+  for (std::size_t first = 0; first < count; first += kBatch) {
+    auto size = std::min(kBatch, count - first);
+    for (std::size_t i = 0; i < size; ++i) { buffer[i] = static_cast<std::uint32_t>(first + i); }
+    co_yield std::span<const std::uint32_t>(buffer.data(), size);
+  }
+}
+
+void bench_batches(std::size_t count)
+{
+  std::cout << "--- summing " << count << " generated ints ---\n";
+  bench::report("co_yield value, element-wise", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto v : one_by_one(count)) { sum += v; }
+    bench::keep(sum);
+  }, 1));
+  bench::report("co_yield span, element-wise", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto v : in_batches(count)) { sum += v; }
+    bench::keep(sum);
+  }, 1));
+  bench::report("co_yield span, chunks()", count, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto chunk : in_batches(count).chunks()) {
+      for (auto v : chunk) { sum += v; }
+    }
+    bench::keep(sum);
+  }, 1));
+}
+
+// recursive_generator as it was before nested generators were resumed from pull():
+// yielding a generator resumes it right from the frame of the outer one, so every
+// level of nesting takes native stack, and destroying the outer frame destroys the
+// nested ones recursively. Values and nested generators only.
+template<typename T> class resuming_generator
+{
+public:
+  struct promise_type
+  {
+    T const *value = nullptr;
+    promise_type *prev = this;
+    promise_type *top_or_root = this;
+
+    static void *operator new(std::size_t size) { return frame_pool::allocate(size); }
+    static void operator delete(void *frame, std::size_t size) noexcept { frame_pool::deallocate(frame, size); }
+
+    bool is_root() const { return prev == this; }
+    promise_type *top() { return top_or_root; }
+    promise_type *root() { return is_root() ? this : top_or_root; }
+    auto handle() { return std::coroutine_handle<promise_type>::from_promise(*this); }
+
+    resuming_generator get_return_object() { return resuming_generator{ handle() }; }
+    std::suspend_always initial_suspend() { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void unhandled_exception() { throw; }
+    void return_void() {}
+
+    std::suspend_always yield_value(T const &v)
+    {
+      value = &v;
+      return {};
+    }
+
+    auto yield_value(resuming_generator &&nested)
+    {
+      auto &inner = nested.impl.promise();
+      inner.prev = this;
+      inner.top_or_root = root();
+      inner.top_or_root->top_or_root = &inner;
+      inner.handle().resume();
+      struct suspend_if
+      {
+        bool ready;
+        bool await_ready() const { return ready; }
+        void await_suspend(std::coroutine_handle<>) const {}
+        void await_resume() const {}
+      };
+      return suspend_if{ top()->handle().done() };
+    }
+
+    void pull()
+    {
+      if (!top()->handle().done()) { top()->handle().resume(); }
+      while (top()->handle().done()) {
+        if (top()->is_root()) { return; }
+        top_or_root = top()->prev;
+        top()->handle().resume();
+      }
+    }
+  };
+
+  resuming_generator(resuming_generator &&rhs) noexcept : impl{ std::exchange(rhs.impl, nullptr) } {}
+  ~resuming_generator()
+  {
+    if (impl) { impl.destroy(); }
+  }
+
+  /// the first value, false if there is none
+  bool start()
+  {
+    impl.promise().pull();
+    return !impl.done();
+  }
+  bool next() { return start(); }
+  T const &value() { return *impl.promise().top()->value; }
+
+private:
+  explicit resuming_generator(std::coroutine_handle<promise_type> impl) : impl{ impl } {}
+
+  std::coroutine_handle<promise_type> impl;
+};
+
+resuming_generator<Node<std::uint32_t> *> post_order_resuming(Node<std::uint32_t> *node)
+{
+  if (node->left) { co_yield post_order_resuming(node->left); }
+  if (node->right) { co_yield post_order_resuming(node->right); }
+  co_yield node;
+}
+
+// delay until the first value and the cost of the rest of a post-order walk of a chain,
+// every value comes from a generator nested `depth` levels deep
+void bench_deep(std::size_t depth)
+{
+  Node<std::uint32_t> *chain = nullptr;
+  for (std::size_t i = 0; i < depth; ++i) { chain = new Node<std::uint32_t>{ static_cast<std::uint32_t>(i), chain, nullptr }; }
+  BinaryTree<std::uint32_t> tree{ chain };
+
+  std::cout << "--- post-order walk of a chain " << depth << " deep ---\n";
+  // deeper chains overflow the stack of the resuming generators
+  if (depth <= kResumingDepth) {
+    bench::report("resuming: first value, then left", 1, bench::measure_ms([&] {
+      auto walk = post_order_resuming(tree.root);
+      walk.start();
+      bench::keep(walk.value());
+    }));
+    bench::report("resuming: whole walk", depth, bench::measure_ms([&] {
+      std::uint64_t sum = 0;
+      auto walk = post_order_resuming(tree.root);
+      for (bool more = walk.start(); more; more = walk.next()) { sum += walk.value()->value; }
+      bench::keep(sum);
+    }));
+  }
+  bench::report("pulled: first value, then left", 1, bench::measure_ms([&] {
+    auto walk = tree.post_order();
+    bench::keep(*walk.begin());
+  }));
+  bench::report("pulled: whole walk", depth, bench::measure_ms([&] {
+    std::uint64_t sum = 0;
+    for (auto *node : tree.post_order()) { sum += node->value; }
+    bench::keep(sum);
+  }));
+}
+
+// runs a traversal once more and tells where its coroutine frames came from
+template<typename Walk> void frames_of(Walk walk)
+{
+  auto before = frame_pool::statistics();
+  walk();
+  auto after = frame_pool::statistics();
+  std::cout << "  frames: " << after.fresh - before.fresh << " from the heap, " << after.reused - before.reused
+            << " reused\n";
+}
+
+void bench_generators(std::size_t count)
+{
+  std::vector<std::uint32_t> keys(count);
+  for (std::size_t i = 0; i < count; ++i) { keys[i] = static_cast<std::uint32_t>(i); }
+  for (bool skewed : { false, true }) {
+    BinaryTree<std::uint32_t> tree{ skewed ? make_skewed(keys, 0, count) : make_nodes(keys, 0, count) };
+    std::cout << "--- post-order generators, " << (skewed ? "skewed" : "balanced") << " tree of " << count
+              << " nodes ---\n";
+
+    bench::report("in order: PreOrderIterator", count, bench::measure_ms([&] {
+      std::uint64_t sum = 0;
+      for (auto it = tree.begin(); it != tree.end(); ++it) { sum += (*it).value; }
+      bench::keep(sum);
+    }));
+    auto reyielding = [&] {
+      std::uint64_t sum = 0;
+      for (auto *node : post_order_reyielding(tree.root)) { sum += node->value; }
+      bench::keep(sum);
+    };
+    bench::report("post order: re-yielding generators", count, bench::measure_ms(reyielding));
+    frames_of(reyielding);
+    auto delegating = [&] {
+      std::uint64_t sum = 0;
+      for (auto *node : tree.post_order()) { sum += node->value; }
+      bench::keep(sum);
+    };
+    bench::report("post order: delegating generators", count, bench::measure_ms(delegating));
+    frames_of(delegating);
+  }
+}
+
+}// namespace
+
+void run_iterator_benchmarks(std::size_t limit)
+{
+  for (std::size_t count = 1'000; count <= std::min<std::size_t>(limit, 4'000'000); count *= 4) { bench_trees(count); }
+  bench_parallel(std::min<std::size_t>(limit, 4'000'000));
+  bench_generators(std::min<std::size_t>(limit, 1'000'000));
+  for (std::size_t depth = 1'000; depth <= std::min<std::size_t>(limit, 1'000'000); depth *= 10) { bench_deep(depth); }
+  // 10^8 with the default limit
+  bench_batches(std::min<std::size_t>(limit, 10'000'000) * 10);
+}
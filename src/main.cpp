@@ -9,6 +9,7 @@
 #include "iter.h"
 #include "solid.h"
 #include "memento.h"
+#include "bench.h"
 #include <CLI/CLI.hpp>
 #include <algorithm>
 #include <cstdlib>
@@ -31,8 +32,16 @@ int main(int argc, const char **argv)
   CLI::App app{ "solid principals tester" };
   std::string testcase = kAllCases;
   bool showVersion = false;
+  bool runBenchmarks = false;
+  std::size_t benchLimit = bench::kDefaultLimit;
   app.add_option(
     "-t,--test-case", testcase, "specific test case to be runned [all]");
+  app.add_flag("-b,--benchmark",
+    runBenchmarks,
+    "runs benchmarks of the test case instead of its examples");
+  app.add_option("-n,--bench-limit",
+    benchLimit,
+    "max number of items processed by a benchmark [10000000]");
 
   app.add_flag_function(
     "-V,--version",
@@ -44,6 +53,18 @@ int main(int argc, const char **argv)
 
   CLI11_PARSE(app, argc, argv);
 
+  if (runBenchmarks) {
+    if (canExecute(testcase, "solid")) { run_solid_benchmarks(benchLimit); }
+    if (canExecute(testcase, "creational")) { run_creational_benchmarks(benchLimit); }
+    if (canExecute(testcase, "composite")) { run_composite_benchmarks(benchLimit); }
+    if (canExecute(testcase, "decorator")) { run_decorator_benchmarks(benchLimit); }
+    if (canExecute(testcase, "flyweight")) { run_flyweight_benchmarks(benchLimit); }
+    if (canExecute(testcase, "iterator")) { run_iterator_benchmarks(benchLimit); }
+    if (canExecute(testcase, "mediator")) { run_mediator_benchmarks(benchLimit); }
+    if (canExecute(testcase, "bflyweight")) { run_bflyweight_benchmarks(benchLimit); }
+    return 0;
+  }
+
   if (canExecute(testcase, "solid")) { run_solid_examples(); }
   if (canExecute(testcase, "creational")) { run_creational_examples(); }
   if (canExecute(testcase, "composite")) { run_composite_examples(); }
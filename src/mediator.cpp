@@ -20,5 +20,10 @@ void run_mediator_examples()
 
   jane.pm("simon", "glad you could join us, simon");
 
+  room.leave(&simon);
+  jane.pm("simon", "nobody gets this one");
+  room.join(&simon);
+  john.pm("simon", "welcome back");
+
   run_mediator_soccer_examples();
 }
\ No newline at end of file
@@ -1,3 +1,6 @@
 #pragma once
 
-void run_mediator_examples();
\ No newline at end of file
+#include <cstddef>
+
+void run_mediator_examples();
+void run_mediator_benchmarks(std::size_t limit);
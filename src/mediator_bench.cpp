@@ -0,0 +1,64 @@
+#include "bench.h"
+#include "chatroom.h"
+#include "mediator.h"
+#include "person.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kMessages = 1'000;
+
+void bench_room(std::size_t members)
+{
+  std::cout << "--- chat room of " << members << " members ---\n";
+  std::vector<Person> people;
+  people.reserve(members + 1);
+  for (std::size_t i = 0; i < members; ++i) {
+    people.emplace_back("person" + std::to_string(i));
+    people.back().session = nullptr;
+  }
+  std::vector<Person *> pointers;
+  for (auto &p : people) { pointers.push_back(&p); }
+
+  ChatRoom room;
+  bench::report("join: all at once", members, bench::measure_ms([&] { room.join(pointers); }, 1));
+
+  people.emplace_back("newcomer");
+  auto &newcomer = people.back();
+  newcomer.session = nullptr;
+  bench::report("join + leave: one more, announced to all", 1, bench::measure_ms([&] {
+    room.join(&newcomer);
+    room.leave(&newcomer);
+  }));
+
+  std::vector<std::string> targets(kMessages);
+  std::mt19937 rng{ 42 };
+  std::uniform_int_distribution<std::size_t> anyone{ 0, members - 1 };
+  for (auto &who : targets) { who = people[anyone(rng)].name; }
+  bench::report("pm: by interned name", kMessages, bench::measure_ms([&] {
+    for (const auto &who : targets) { people[0].pm(who, "psst"); }
+  }));
+  // what message() did before: a search through the members for every message
+  bench::report("pm: linear search", kMessages, bench::measure_ms([&] {
+    for (const auto &who : targets) {
+      auto it = std::find_if(pointers.begin(), pointers.end(), [&who](const Person *p) { return p->name == who; });
+      if (it != pointers.end()) { (*it)->receive(people[0].name, "psst"); }
+    }
+  }));
+
+  bench::report("broadcast: one shared line", members, bench::measure_ms([&] { people[0].say("hello everyone"); }));
+  bench::keep(people[1].chat_log.size());
+}
+
+}// namespace
+
+void run_mediator_benchmarks(std::size_t limit)
+{
+  for (std::size_t members : { 10U, 10'000U, 1'000'000U }) {
+    if (members <= limit) { bench_room(members); }
+  }
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "string_interner.h"
+
+// Dense table of interned names: ids are small integers, id -> name is a
+// lock-free load and names may be interned and read from several threads,
+// one at a time with intern() or in batches with intern_bulk().
+// statistics() tells how many bytes sharing the names saved.
+using NameTable = StringInterner;
@@ -1,13 +1,24 @@
 #include "person.h"
 #include "chatroom.h"
+#include <memory>
+#include <mutex>
 
 Person::Person(const string &name) : name(name) {}
 
 void Person::receive(const string &origin, const string &message)
 {
-  string s{ origin + ": \"" + message + "\"" };
-  cout << "[" << name << "'s chat session] " << s << "\n";
-  chat_log.emplace_back(s);
+  receive(std::make_shared<const string>(origin + ": \"" + message + "\""));
+}
+
+void Person::receive(const ChatLine &line)
+{
+  if (session) {
+    // sessions share cout and big rooms deliver from several threads
+    static std::mutex mtx;
+    std::lock_guard lock{ mtx };
+    *session << "[" << name << "'s chat session] " << *line << "\n";
+  }
+  chat_log.push_back(line);
 }
 
 void Person::say(const string &message) const
@@ -1,22 +1,26 @@
 #pragma once
+#include <cstddef>
 #include <string>
 #include <iostream>
 #include <vector>
 
-using namespace std;
+#include "chatroom.h"
 
-struct ChatRoom;
+using namespace std;
 
 struct Person
 {
   string name;
   ChatRoom *room = nullptr;
+  std::size_t room_index = 0;// place in the room, kept by the room
+  ostream *session = &cout;// where received lines are shown, none if null
 
   Person(const string &name);
   void receive(const string &origin, const string &message);
+  void receive(const ChatLine &line);
 
   void say(const string &message) const;
-  vector<string> chat_log;
+  vector<ChatLine> chat_log;
 
   void pm(const string &who, const string &message) const;
 
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ----- composite builder ------
+//
+class PersonBuilder;
+class PersonAddressBuilder;
+class PersonJobBuilder;
+
+class Person
+{
+  friend class PersonBuilder;
+  friend class PersonAddressBuilder;
+  friend class PersonJobBuilder;
+  // address
+  std::string street_address, post_code, city;
+
+  // employment
+  std::string company_name, position;
+  int annual_income = 0;
+
+  Person() = default;
+
+  friend std::ostream &operator<<(std::ostream &ost, const Person &per)
+  {
+    ost << "street: " << per.street_address;
+    ost << ", ";
+    ost << "position: " << per.position;
+    ost << ", ";
+    ost << "city: " << per.city;
+    ost << ", ";
+    ost << "company_name: " << per.company_name;
+    ost << ", ";
+    ost << "annual_income: " << per.annual_income;
+    return ost;
+  }
+
+public:
+  static PersonBuilder create();
+};
+
+
+class PersonBuilderBase
+{
+protected:
+  Person &person;
+
+  explicit PersonBuilderBase(Person &person) : person(person) {}
+
+public:
+  operator Person() { return std::move(person); }
+
+  PersonAddressBuilder lives() const;
+  PersonJobBuilder works() const;
+};
+
+class PersonBuilder : public PersonBuilderBase
+{
+  Person p;
+
+public:
+  PersonBuilder() : PersonBuilderBase(p) {}
+};
+
+class PersonAddressBuilder : public PersonBuilderBase
+{
+  using self = PersonAddressBuilder;
+
+public:
+  explicit PersonAddressBuilder(Person &person) : PersonBuilderBase(person) {}
+
+  self &at(std::string street_address)
+  {
+    person.street_address = std::move(street_address);
+    return *this;
+  }
+
+  self &with(std::string post_code)
+  {
+    person.post_code = std::move(post_code);
+    return *this;
+  }
+
+  self &in(std::string city)
+  {
+    person.city = std::move(city);
+    return *this;
+  }
+};
+
+class PersonJobBuilder : public PersonBuilderBase
+{
+  using self = PersonJobBuilder;
+
+public:
+  explicit PersonJobBuilder(Person &person) : PersonBuilderBase(person) {}
+
+  self &at(std::string company_name)
+  {
+    person.company_name = std::move(company_name);
+    return *this;
+  }
+
+  self &as_a(std::string position)
+  {
+    person.position = std::move(position);
+    return *this;
+  }
+
+  self &earning(int salary)
+  {
+    person.annual_income = salary;
+    return *this;
+  }
+};
+
+inline PersonBuilder Person::create() { return {}; }
+
+inline PersonJobBuilder PersonBuilderBase::works() const { return PersonJobBuilder(person); }
+inline PersonAddressBuilder PersonBuilderBase::lives() const { return PersonAddressBuilder(person); }
+
+// ----- typed in place builder ------
+//
+// The faceted builder above creates a builder object per facet switch,
+// copies every string into the Person and converts by moving out of a
+// reference, which dangles once the PersonBuilder temporary is gone.
+// Below records are built for a PersonBatch: strings are appended to the
+// batch arena and records only refer to them, and the type
+// of a builder tells which fields were set, so build() doesn't compile
+// unless the required ones are there:
+//
+//   PersonBatch batch;
+//   batch.add().lives().at("123 London Road").in("London").works().at("PragmaSoft").build();
+//   batch.add().lives().in("London").build();// error: street address is required
+
+/// person whose strings belong to the PersonBatch it was built in
+struct PersonRecord
+{
+  std::string_view street_address, post_code, city;
+  std::string_view company_name, position;
+  int annual_income = 0;
+
+  friend std::ostream &operator<<(std::ostream &ost, const PersonRecord &per)
+  {
+    return ost << "street: " << per.street_address << ", position: " << per.position << ", city: " << per.city
+               << ", company_name: " << per.company_name << ", annual_income: " << per.annual_income;
+  }
+};
+
+namespace person_fields {
+enum : unsigned {
+  none = 0,
+  street_address = 1U << 0U,
+  post_code = 1U << 1U,
+  city = 1U << 2U,
+  company_name = 1U << 3U,
+  position = 1U << 4U,
+  annual_income = 1U << 5U,
+};
+}// namespace person_fields
+
+template<unsigned Fields> class PersonRecordAddressBuilder;
+template<unsigned Fields> class PersonRecordJobBuilder;
+
+class PersonBatch
+{
+public:
+  explicit PersonBatch(std::size_t initial_bytes = 64 * 1024) : strings(initial_bytes) {}
+
+  PersonBatch(const PersonBatch &) = delete;
+  PersonBatch &operator=(const PersonBatch &) = delete;
+
+  /// starts a new record, it's added to the batch by build()
+  PersonRecordAddressBuilder<person_fields::none> add();
+
+  void reserve(std::size_t count) { records.reserve(count); }
+  [[nodiscard]] std::size_t size() const { return records.size(); }
+  [[nodiscard]] const PersonRecord &operator[](std::size_t i) const { return records[i]; }
+  [[nodiscard]] auto begin() const { return records.begin(); }
+  [[nodiscard]] auto end() const { return records.end(); }
+
+private:
+  template<unsigned> friend class PersonRecordBuilderBase;
+
+  std::string_view keep(std::string_view text)
+  {
+    if (text.empty()) { return {}; }
+    auto *buf = static_cast<char *>(strings.allocate(text.size(), 1));
+    std::copy(text.begin(), text.end(), buf);
+    return { buf, text.size() };
+  }
+
+  std::pmr::monotonic_buffer_resource strings;
+  std::vector<PersonRecord> records;
+};
+
+template<unsigned Fields> class PersonRecordBuilderBase
+{
+public:
+  // every builder carries its own copy of the record (a few views and an int),
+  // so builders started by different add() calls don't see each other's fields
+  explicit PersonRecordBuilderBase(PersonBatch &batch, const PersonRecord &rec = {}) : batch(&batch), rec(rec) {}
+
+  PersonRecordAddressBuilder<Fields> lives() const { return PersonRecordAddressBuilder<Fields>{ *batch, rec }; }
+  PersonRecordJobBuilder<Fields> works() const { return PersonRecordJobBuilder<Fields>{ *batch, rec }; }
+
+  /// adds the record to the batch and returns a copy of it, a reference into
+  /// the batch wouldn't survive the next add(); the views stay valid with the batch
+  PersonRecord build() const
+  {
+    static_assert((Fields & person_fields::street_address) != 0, "street address is required, call lives().at()");
+    static_assert((Fields & person_fields::city) != 0, "city is required, call lives().in()");
+    static_assert((Fields & person_fields::company_name) != 0, "company name is required, call works().at()");
+    batch->records.push_back(rec);
+    return rec;
+  }
+
+protected:
+  std::string_view keep(std::string_view text) const { return batch->keep(text); }
+
+  PersonBatch *batch;
+  PersonRecord rec;
+};
+
+template<unsigned Fields> class PersonRecordAddressBuilder : public PersonRecordBuilderBase<Fields>
+{
+  using base = PersonRecordBuilderBase<Fields>;
+
+public:
+  using base::base;
+
+  PersonRecordAddressBuilder<Fields | person_fields::street_address> at(std::string_view street_address) const
+  {
+    auto next = this->rec;
+    next.street_address = this->keep(street_address);
+    return PersonRecordAddressBuilder<Fields | person_fields::street_address>{ *this->batch, next };
+  }
+
+  PersonRecordAddressBuilder<Fields | person_fields::post_code> with(std::string_view post_code) const
+  {
+    auto next = this->rec;
+    next.post_code = this->keep(post_code);
+    return PersonRecordAddressBuilder<Fields | person_fields::post_code>{ *this->batch, next };
+  }
+
+  PersonRecordAddressBuilder<Fields | person_fields::city> in(std::string_view city) const
+  {
+    auto next = this->rec;
+    next.city = this->keep(city);
+    return PersonRecordAddressBuilder<Fields | person_fields::city>{ *this->batch, next };
+  }
+};
+
+template<unsigned Fields> class PersonRecordJobBuilder : public PersonRecordBuilderBase<Fields>
+{
+  using base = PersonRecordBuilderBase<Fields>;
+
+public:
+  using base::base;
+
+  PersonRecordJobBuilder<Fields | person_fields::company_name> at(std::string_view company_name) const
+  {
+    auto next = this->rec;
+    next.company_name = this->keep(company_name);
+    return PersonRecordJobBuilder<Fields | person_fields::company_name>{ *this->batch, next };
+  }
+
+  PersonRecordJobBuilder<Fields | person_fields::position> as_a(std::string_view position) const
+  {
+    auto next = this->rec;
+    next.position = this->keep(position);
+    return PersonRecordJobBuilder<Fields | person_fields::position>{ *this->batch, next };
+  }
+
+  PersonRecordJobBuilder<Fields | person_fields::annual_income> earning(int salary) const
+  {
+    auto next = this->rec;
+    next.annual_income = salary;
+    return PersonRecordJobBuilder<Fields | person_fields::annual_income>{ *this->batch, next };
+  }
+};
+
+inline PersonRecordAddressBuilder<person_fields::none> PersonBatch::add()
+{
+  return PersonRecordAddressBuilder<person_fields::none>{ *this };
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "person_builder.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Columnar batch of persons.
+// Building Person objects one by one scatters their strings all over the
+// heap. Here every field is a column: strings of a column share one buffer
+// (string i is bytes[offsets[i], offsets[i + 1])), incomes are a packed
+// integer column and cities, which repeat a lot, are dictionary encoded,
+// so aggregations per city work on small integer codes.
+
+struct StringColumn
+{
+  std::string bytes;
+  std::vector<std::uint32_t> offsets{ 0 };
+
+  void push_back(std::string_view text)
+  {
+    check_fits(text.size());
+    bytes += text;
+    offsets.push_back(static_cast<std::uint32_t>(bytes.size()));
+  }
+
+  /// appends all strings of other
+  void append(const StringColumn &other);
+
+  [[nodiscard]] std::size_t size() const { return offsets.size() - 1; }
+  [[nodiscard]] std::string_view operator[](std::size_t i) const
+  {
+    return { bytes.data() + offsets[i], offsets[i + 1] - offsets[i] };
+  }
+
+  /// offsets are 32-bit to keep the column small, so a column holds up to 4 GiB of text
+  void check_fits(std::size_t more) const
+  {
+    if (more > std::numeric_limits<std::uint32_t>::max() - bytes.size()) {
+      throw std::length_error("StringColumn: text doesn't fit 32-bit offsets");
+    }
+  }
+};
+
+struct PersonColumns
+{
+  StringColumn street_address, post_code;
+  std::vector<std::uint32_t> city;// codes into cities
+  StringColumn cities;// distinct city names
+  StringColumn company_name, position;
+  std::vector<std::int32_t> annual_income;
+
+  [[nodiscard]] std::size_t size() const { return annual_income.size(); }
+  /// views of one row, valid while the columns live
+  [[nodiscard]] PersonRecord operator[](std::size_t i) const;
+
+  struct CityIncome
+  {
+    std::string_view city;
+    std::int64_t total = 0;
+    std::size_t count = 0;
+
+    [[nodiscard]] double average() const { return count ? static_cast<double>(total) / static_cast<double>(count) : 0.0; }
+  };
+
+  [[nodiscard]] std::int64_t total_income() const;
+  [[nodiscard]] double average_income() const;
+  /// total and average income per city, in the order cities were first seen
+  [[nodiscard]] std::vector<CityIncome> income_by_city() const;
+};
+
+class PersonBatchBuilder
+{
+public:
+  void reserve(std::size_t records);
+
+  PersonBatchBuilder &add(const PersonRecord &per);
+  PersonBatchBuilder &add(std::string_view street_address,
+    std::string_view post_code,
+    std::string_view city,
+    std::string_view company_name,
+    std::string_view position,
+    int annual_income);
+
+  /// appends everything added to other (the order is kept)
+  PersonBatchBuilder &merge(PersonBatchBuilder &&other);
+
+  [[nodiscard]] std::size_t size() const { return columns.size(); }
+  PersonColumns build() &&;
+
+  /// builds `count` records on a thread pool, fill(i, builder) has to add record i;
+  /// every task fills its own builder and they are merged in order
+  template<typename Fill>
+  static PersonColumns build_parallel(std::size_t count, Fill fill, ThreadPool &pool = ThreadPool::shared())
+  {
+    constexpr std::size_t kMinChunk = 64 * 1024;
+    std::size_t chunks = std::max<std::size_t>(1, std::min(pool.size() * 2, count / kMinChunk));
+    std::size_t per_chunk = (count + chunks - 1) / chunks;
+
+    std::vector<PersonBatchBuilder> parts(chunks);
+    TaskGroup group{ pool };
+    for (std::size_t c = 0; c < chunks; ++c) {
+      group.run([&parts, &fill, c, per_chunk, count] {
+        std::size_t begin = std::min(count, c * per_chunk);
+        std::size_t end = std::min(count, begin + per_chunk);
+        parts[c].reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) { fill(i, parts[c]); }
+      });
+    }
+    group.wait();
+
+    PersonBatchBuilder all;
+    for (auto &part : parts) { all.merge(std::move(part)); }
+    return std::move(all).build();
+  }
+
+private:
+  std::uint32_t city_code(std::string_view city);
+
+  // allows looking up std::string keys by std::string_view
+  struct string_hash
+  {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+  };
+
+  PersonColumns columns;
+  std::unordered_map<std::string, std::uint32_t, string_hash, std::equal_to<>> city_codes;
+};
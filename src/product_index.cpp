@@ -0,0 +1,96 @@
+#include "product_index.h"
+
+IndexedProductStore::id IndexedProductStore::insert(Product prd)
+{
+  id row;
+  if (free_ids.empty()) {
+    row = static_cast<id>(rows.size());
+    rows.push_back(std::move(prd));
+  } else {
+    row = free_ids.back();
+    free_ids.pop_back();
+    rows[row] = std::move(prd);
+  }
+
+  alive.add(row);
+  by_color[static_cast<std::size_t>(rows[row].color)].add(row);
+  by_size[static_cast<std::size_t>(rows[row].size)].add(row);
+  return row;
+}
+
+bool IndexedProductStore::erase(id row)
+{
+  if (!alive.contains(row)) { return false; }
+
+  alive.remove(row);
+  by_color[static_cast<std::size_t>(rows[row].color)].remove(row);
+  by_size[static_cast<std::size_t>(rows[row].size)].remove(row);
+  rows[row] = Product{};
+  free_ids.push_back(row);
+  return true;
+}
+
+namespace {
+
+/// true if the whole tree can be answered from indexes only
+bool indexable(Specification<Product> &spec)
+{
+  if (dynamic_cast<ColorSpecification *>(&spec) || dynamic_cast<SizeSpecification *>(&spec)) { return true; }
+  if (auto *and_spec = dynamic_cast<AndSpecification<Product> *>(&spec)) {
+    return indexable(and_spec->first) && indexable(and_spec->second);
+  }
+  if (auto *or_spec = dynamic_cast<OrSpecification<Product> *>(&spec)) {
+    return indexable(or_spec->first) && indexable(or_spec->second);
+  }
+  if (auto *not_spec = dynamic_cast<NotSpecification<Product> *>(&spec)) { return indexable(not_spec->inner); }
+  return false;
+}
+
+}// namespace
+
+// ids satisfying spec, limited to `within` (all alive products if nullptr)
+Bitmap IndexedProductStore::evaluate(Specification<Product> &spec, const Bitmap *within) const
+{
+  if (auto *col = dynamic_cast<ColorSpecification *>(&spec)) {
+    const auto &ids = by_color[static_cast<std::size_t>(col->color)];
+    return within ? ids & *within : ids;
+  }
+  if (auto *sz = dynamic_cast<SizeSpecification *>(&spec)) {
+    const auto &ids = by_size[static_cast<std::size_t>(sz->sz)];
+    return within ? ids & *within : ids;
+  }
+  if (auto *and_spec = dynamic_cast<AndSpecification<Product> *>(&spec)) {
+    // the index-only side goes first, so the other one is checked
+    // against its (usually much smaller) result only
+    auto *first = &and_spec->first;
+    auto *second = &and_spec->second;
+    if (!indexable(*first) && indexable(*second)) { std::swap(first, second); }
+    auto narrowed = evaluate(*first, within);
+    if (narrowed.empty()) { return narrowed; }
+    return evaluate(*second, &narrowed);
+  }
+  if (auto *or_spec = dynamic_cast<OrSpecification<Product> *>(&spec)) {
+    return evaluate(or_spec->first, within) | evaluate(or_spec->second, within);
+  }
+  if (auto *not_spec = dynamic_cast<NotSpecification<Product> *>(&spec)) {
+    return and_not(within ? *within : alive, evaluate(not_spec->inner, within));
+  }
+
+  // unknown specification: check it product by product
+  Bitmap found;
+  (within ? *within : alive).for_each([&](id row) {
+    if (spec.is_satisfied(rows[row])) { found.add(row); }
+  });
+  return found;
+}
+
+Bitmap IndexedProductStore::query(Specification<Product> &spec) const { return evaluate(spec, nullptr); }
+
+std::vector<Product> IndexedProductStore::filter(Specification<Product> &spec) const
+{
+  auto ids = query(spec);
+  std::vector<Product> result;
+  result.reserve(ids.cardinality());
+  ids.for_each([&](id row) { result.push_back(rows[row]); });
+  return result;
+}
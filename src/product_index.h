@@ -0,0 +1,42 @@
+#pragma once
+
+#include "bitmap.h"
+#include "solid.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Product store which keeps a bitmap index for every Color and Size value.
+// A Specification tree is turned by a small planner into AND/OR/AND-NOT
+// operations over those bitmaps, so a query costs proportionally to the
+// size of the bitmaps and not to the number of products.
+// Indexes are maintained incrementally on insert and erase.
+
+class IndexedProductStore
+{
+public:
+  using id = std::uint32_t;
+
+  /// adds a product and returns its id (ids of erased products are reused)
+  id insert(Product prd);
+  /// removes a product, returns false if the id isn't in use
+  bool erase(id row);
+
+  [[nodiscard]] const Product &operator[](id row) const { return rows[row]; }
+  [[nodiscard]] std::size_t size() const { return alive.cardinality(); }
+
+  /// ids of products satisfying the specification
+  [[nodiscard]] Bitmap query(Specification<Product> &spec) const;
+  /// same as query(), but with copies of products
+  [[nodiscard]] std::vector<Product> filter(Specification<Product> &spec) const;
+
+private:
+  Bitmap evaluate(Specification<Product> &spec, const Bitmap *within) const;
+
+  std::vector<Product> rows;
+  std::vector<id> free_ids;
+  Bitmap alive;
+  // indexed by the value of an enum
+  std::array<Bitmap, 3> by_color;
+  std::array<Bitmap, 3> by_size;
+};
@@ -0,0 +1,188 @@
+#include "product_table.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+void ProductTable::reserve(std::size_t rows, std::size_t name_bytes)
+{
+  colors.reserve(rows);
+  sizes.reserve(rows);
+  name_offsets.reserve(rows + 1);
+  names.reserve(name_bytes);
+}
+
+void ProductTable::push_back(const Product &prd)
+{
+  // offsets are 32-bit to keep the column small, names past 4 GiB can't be addressed
+  if (prd.name.size() > std::numeric_limits<std::uint32_t>::max() - names.size()) {
+    throw std::length_error("ProductTable: names don't fit 32-bit offsets");
+  }
+  colors.push_back(static_cast<std::uint8_t>(prd.color));
+  sizes.push_back(static_cast<std::uint8_t>(prd.size));
+  names += prd.name;
+  name_offsets.push_back(static_cast<std::uint32_t>(names.size()));
+}
+
+Product ProductTable::product(std::size_t row) const
+{
+  return { std::string{ name(row) }, color(row), size_of(row) };
+}
+
+ProductTable ProductTable::from(const std::vector<Product> &items)
+{
+  std::size_t name_bytes = 0;
+  for (const auto &prd : items) { name_bytes += prd.name.size(); }
+
+  ProductTable table;
+  table.reserve(items.size(), name_bytes);
+  for (const auto &prd : items) { table.push_back(prd); }
+  return table;
+}
+
+namespace {
+
+// rows are processed in blocks so all masks of a plan stay in L1 cache
+constexpr std::size_t kBlock = 4096;
+
+enum class Op : std::uint8_t { Color, Size, And, Or, Not, Generic };
+
+constexpr std::uint32_t kNoChild = UINT32_MAX;
+
+struct PlanNode
+{
+  Op op;
+  std::uint8_t value = 0;
+  std::uint32_t left = kNoChild;
+  std::uint32_t right = kNoChild;
+  Specification<Product> *spec = nullptr;
+};
+
+// flat representation of a specification tree, node 0 is the root
+struct Plan
+{
+  std::vector<PlanNode> nodes;
+  std::size_t depth = 0;
+
+  std::uint32_t add(Specification<Product> &spec, std::size_t level)
+  {
+    depth = std::max(depth, level + 1);
+    auto at = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back({});
+
+    if (auto *col = dynamic_cast<ColorSpecification *>(&spec)) {
+      nodes[at] = { Op::Color, static_cast<std::uint8_t>(col->color) };
+    } else if (auto *sz = dynamic_cast<SizeSpecification *>(&spec)) {
+      nodes[at] = { Op::Size, static_cast<std::uint8_t>(sz->sz) };
+    } else if (auto *and_spec = dynamic_cast<AndSpecification<Product> *>(&spec)) {
+      auto left = add(and_spec->first, level + 1);
+      auto right = add(and_spec->second, level + 1);
+      nodes[at] = { Op::And, 0, left, right };
+    } else if (auto *or_spec = dynamic_cast<OrSpecification<Product> *>(&spec)) {
+      auto left = add(or_spec->first, level + 1);
+      auto right = add(or_spec->second, level + 1);
+      nodes[at] = { Op::Or, 0, left, right };
+    } else if (auto *not_spec = dynamic_cast<NotSpecification<Product> *>(&spec)) {
+      auto inner = add(not_spec->inner, level + 1);
+      nodes[at] = { Op::Not, 0, inner };
+    } else {
+      nodes[at] = { Op::Generic, 0, kNoChild, kNoChild, &spec };
+    }
+    return at;
+  }
+};
+
+// the kernels below have no branches in their loops,
+// so they are turned into SIMD compares/ands/ors by the optimizer
+
+void equal_kernel(const std::uint8_t *column, std::uint8_t value, std::size_t count, std::uint8_t *out)
+{
+  for (std::size_t i = 0; i < count; ++i) { out[i] = static_cast<std::uint8_t>(column[i] == value); }
+}
+
+void and_kernel(std::uint8_t *out, const std::uint8_t *other, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i) { out[i] &= other[i]; }
+}
+
+void or_kernel(std::uint8_t *out, const std::uint8_t *other, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i) { out[i] |= other[i]; }
+}
+
+void not_kernel(std::uint8_t *out, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i) { out[i] ^= 1; }
+}
+
+struct Evaluator
+{
+  const ProductTable &table;
+  const Plan &plan;
+  // one scratch mask per tree level
+  std::vector<std::vector<std::uint8_t>> scratch;
+
+  Evaluator(const ProductTable &table, const Plan &plan)
+    : table(table), plan(plan), scratch(plan.depth, std::vector<std::uint8_t>(kBlock))
+  {}
+
+  void eval(std::uint32_t at, std::size_t level, std::size_t begin, std::size_t count, std::uint8_t *out)
+  {
+    const auto &node = plan.nodes[at];
+    switch (node.op) {
+    case Op::Color:
+      equal_kernel(table.colors.data() + begin, node.value, count, out);
+      break;
+    case Op::Size:
+      equal_kernel(table.sizes.data() + begin, node.value, count, out);
+      break;
+    case Op::And:
+    case Op::Or: {
+      eval(node.left, level + 1, begin, count, out);
+      auto *tmp = scratch[level].data();
+      eval(node.right, level + 1, begin, count, tmp);
+      if (node.op == Op::And) {
+        and_kernel(out, tmp, count);
+      } else {
+        or_kernel(out, tmp, count);
+      }
+      break;
+    }
+    case Op::Not:
+      eval(node.left, level + 1, begin, count, out);
+      not_kernel(out, count);
+      break;
+    case Op::Generic:
+      for (std::size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<std::uint8_t>(node.spec->is_satisfied(table.product(begin + i)));
+      }
+      break;
+    }
+  }
+};
+
+}// namespace
+
+std::vector<ProductTable::index> ColumnarFilter::filter(const ProductTable &table, Specification<Product> &spec)
+{
+  Plan plan;
+  plan.add(spec, 0);
+  Evaluator evaluator{ table, plan };
+
+  std::vector<ProductTable::index> result;
+  std::vector<std::uint8_t> mask(kBlock);
+  std::vector<ProductTable::index> selected(kBlock);
+
+  for (std::size_t begin = 0; begin < table.size(); begin += kBlock) {
+    auto count = std::min(kBlock, table.size() - begin);
+    evaluator.eval(0, 0, begin, count, mask.data());
+
+    // branch-free compaction: every index is written, only matches advance
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      selected[found] = static_cast<ProductTable::index>(begin + i);
+      found += mask[i];
+    }
+    result.insert(result.end(), selected.begin(), selected.begin() + static_cast<std::ptrdiff_t>(found));
+  }
+  return result;
+}
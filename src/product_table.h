@@ -0,0 +1,55 @@
+#pragma once
+
+#include "solid.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Columnar (structure-of-arrays) storage for products.
+// BetterFilter works on a vector of Product objects: every item drags its
+// name along even if only color and size are checked. Here each attribute
+// lives in its own column, so a filter touches two bytes per row only.
+
+struct ProductTable
+{
+  using index = std::uint32_t;
+
+  void reserve(std::size_t rows, std::size_t name_bytes = 0);
+  void push_back(const Product &prd);
+
+  [[nodiscard]] std::size_t size() const { return colors.size(); }
+  [[nodiscard]] bool empty() const { return colors.empty(); }
+
+  [[nodiscard]] Color color(std::size_t row) const { return static_cast<Color>(colors[row]); }
+  [[nodiscard]] Size size_of(std::size_t row) const { return static_cast<Size>(sizes[row]); }
+  [[nodiscard]] std::string_view name(std::size_t row) const
+  {
+    return { names.data() + name_offsets[row], name_offsets[row + 1] - name_offsets[row] };
+  }
+
+  /// materializes a row back into a Product (copies the name)
+  [[nodiscard]] Product product(std::size_t row) const;
+
+  static ProductTable from(const std::vector<Product> &items);
+
+  // columns
+  std::vector<std::uint8_t> colors;
+  std::vector<std::uint8_t> sizes;
+  // all names are stored one after another in a single arena,
+  // name of row i is names[name_offsets[i], name_offsets[i + 1])
+  std::string names;
+  std::vector<std::uint32_t> name_offsets{ 0 };
+};
+
+/// evaluates a Specification tree over the columns of a ProductTable
+/// and returns indexes of matching rows (a selection vector) instead of
+/// copies of the products.
+/// Color/Size/And/Or/Not specifications are translated into byte-mask kernels
+/// which work on blocks of rows and are vectorized by the compiler,
+/// any other specification falls back to a row by row is_satisfied() call.
+struct ColumnarFilter
+{
+  static std::vector<ProductTable::index> filter(const ProductTable &table, Specification<Product> &spec);
+};
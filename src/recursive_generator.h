@@ -1,15 +1,28 @@
 #pragma once
 
+#include <array>
 #include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 // This class implements delegating (potentially recursive) recursive_generator.
-// It supports two kind of yield expressions:
+// It supports three kinds of yield expressions:
 //
 //    co_yield V;
 //    co_yield G_of_T;
+//    co_yield S_of_T;
 //
-// Where V is a value convertible to T and
-// G_of_T is a recursive_generator<T>.
+// Where V is a value convertible to T,
+// G_of_T is a recursive_generator<T> and
+// S_of_T is a std::span<const T>: consumers iterating single
+// values get its elements one by one, the ones iterating chunks() get
+// the whole span at once, so a loop over it can be vectorized.
 //
 // Usage example:
 //
@@ -35,17 +48,122 @@
 //   }
 //
 // Output: 1 10 11 12 13 14 -1 1000 2000 3000 4000 5000 6000 7000 8000 9000
+//
+// Coroutine frames come from frame_pool: a nested generator lives shortly
+// and the next one usually needs a frame of the same size, so freed frames
+// are kept per thread and given out again instead of going back to the heap.
+
+namespace frame_pool {
+
+inline constexpr std::size_t kGranularity = 64;// frames are rounded up to this
+inline constexpr std::size_t kClasses = 16;// bigger frames than kClasses * kGranularity use the heap
+inline constexpr std::size_t kKept = 1024;// frames of one size kept at most
+
+struct counters
+{
+  std::size_t fresh = 0;// frames taken from the heap
+  std::size_t reused = 0;// frames given out again
+};
+
+namespace detail {
+
+struct Block
+{
+  Block *next;
+};
+
+struct Pool
+{
+  std::array<Block *, kClasses> free{};
+  std::array<std::size_t, kClasses> kept{};
+  counters stats;
+
+  ~Pool()
+  {
+    destroyed() = true;
+    for (auto *block : free) {
+      while (block) { ::operator delete(std::exchange(block, block->next)); }
+    }
+  }
+
+  // frames freed after the pool of the thread is gone skip it
+  static bool &destroyed()
+  {
+    thread_local bool flag = false;
+    return flag;
+  }
+};
+
+inline Pool &local()
+{
+  thread_local Pool pool;
+  return pool;
+}
+
+}// namespace detail
+
+inline void *allocate(std::size_t size)
+{
+  const std::size_t cls = (size + kGranularity - 1) / kGranularity - 1;
+  if (cls >= kClasses) { return ::operator new(size); }
+  auto &pool = detail::local();
+  if (auto *block = pool.free[cls]) {
+    pool.free[cls] = block->next;
+    --pool.kept[cls];
+    ++pool.stats.reused;
+    return block;
+  }
+  ++pool.stats.fresh;
+  return ::operator new((cls + 1) * kGranularity);
+}
+
+/// a frame may be freed by another thread than the one which allocated it, it goes to the pool of the freeing one
+inline void deallocate(void *frame, std::size_t size) noexcept
+{
+  const std::size_t cls = (size + kGranularity - 1) / kGranularity - 1;
+  if (cls >= kClasses || detail::Pool::destroyed()) {
+    ::operator delete(frame);
+    return;
+  }
+  auto &pool = detail::local();
+  if (pool.kept[cls] == kKept) {
+    ::operator delete(frame);
+    return;
+  }
+  pool.free[cls] = new (frame) detail::Block{ pool.free[cls] };
+  ++pool.kept[cls];
+}
+
+/// counts of the calling thread
+inline counters statistics() { return detail::local().stats; }
+
+}// namespace frame_pool
 
 
 template <typename T> struct recursive_generator {
   struct promise_type;
   using handle = std::coroutine_handle<promise_type>;
 
+  struct suspend_if {
+    bool _Ready;
+    explicit suspend_if(bool _Condition) : _Ready(!_Condition) {}
+    bool await_ready() { return _Ready; }
+    void await_suspend(std::coroutine_handle<>) {}
+    void await_resume() {}
+  };
+
   struct promise_type {
-    T const *value;
+    // values of the last co_yield: one value or a whole span
+    T const *first;
+    std::size_t count;
 
     promise_type *prev;
     promise_type *top_or_root;
+    recursive_generator *owner = nullptr;// the generator object a nested one was yielded as
+    // kept in the root only
+    std::exception_ptr error;// thrown by any of the nested generators
+    bool ready = false;// a value was yielded by the last resume
+    bool stopped = false;// after an exception
 
     promise_type *top() { return top_or_root; }
     promise_type *root() {
@@ -59,9 +177,12 @@ template <typename T> struct recursive_generator {
 
     promise_type() : prev(this), top_or_root(this) {}
 
+    static void *operator new(std::size_t size) { return frame_pool::allocate(size); }
+    static void operator delete(void *frame, std::size_t size) noexcept { frame_pool::deallocate(frame, size); }
+
     bool is_root() { return prev == this; }
 
-    T const &get() { return *value; }
+    T const &get() { return *first; }
 
     void resume() { handle::from_promise(*this)(); }
     bool done() { return handle::from_promise(*this).done(); }
@@ -72,88 +193,207 @@ template <typename T> struct recursive_generator {
 
     auto final_suspend() noexcept { return std::suspend_always{}; }
 
-    void unhandled_exception() { throw; }
+    void unhandled_exception() { root()->error = std::current_exception(); }
+
+    void return_void() {}
 
     auto yield_value(T const &v) {
-      value = &v;
+      first = &v;
+      count = 1;
+      root()->ready = true;
       return std::suspend_always{};
     }
 
+    // the span has to stay valid until the coroutine is resumed,
+    // an empty one doesn't suspend at all
+    auto yield_value(std::span<const T> values) {
+      first = values.data();
+      count = values.size();
+      root()->ready = count != 0;
+      return suspend_if(count != 0);
+    }
+
+    // the nested generator isn't resumed from here but by pull(), so
+    // however deep generators are nested the stack doesn't grow
     auto yield_value(recursive_generator<T> &&v) {
       auto &inner = v.impl.promise();
       inner.prev = this;
+      inner.owner = &v;
       inner.top_or_root = root();
-      inner.top_or_root->top_or_root = &v.impl.promise();
-
-      inner.resume();
-
-      struct suspend_if {
-        bool _Ready;
-        explicit suspend_if(bool _Condition) : _Ready(!_Condition) {}
-        bool await_ready() { return _Ready; }
-        void await_suspend(std::coroutine_handle<>) {}
-        void await_resume() {}
-      };
-
-      return suspend_if(!top()->done());
+      inner.top_or_root->top_or_root = &inner;
+      return std::suspend_always{};
     }
 
-    void pull() {
-      if (!top()->done()) {
-        top()->resume();
-      }
-      while (top()->done()) {
-        if (top()->is_root())
-          return;
-
-        top_or_root = top()->prev;
+    // Resumes the innermost generator until there is a value, false if
+    // there are no more values. Called on the root. Generators are resumed
+    // one after another from this loop, never from each other, and an
+    // exception of any of them comes out of here.
+    bool pull() {
+      ready = false;
+      while (!stopped) {
+        auto *inner = top();
+        if (inner->done()) {
+          if (inner == this)
+            return false;
+          // the generator it was yielded from goes on and destroys it
+          set_top(inner->prev);
+        }
         top()->resume();
+        if (error) {
+          stopped = true;
+          std::rethrow_exception(std::exchange(error, nullptr));
+        }
+        if (ready)
+          return true;
       }
+      return false;
     }
   };
 
-  ~recursive_generator() {
-    if (impl) {
-      impl.destroy();
-    }
-  }
+  ~recursive_generator() { destroy_chain(); }
 
+  /// input iterator over single values, the end is std::default_sentinel
   struct iterator {
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::remove_cvref_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = T const &;
+
     handle rh;
+    T const *at = nullptr;// the current value within the current span
+    T const *last = nullptr;
 
+    iterator() = default;
     iterator(decltype(nullptr)) {}
-    iterator(handle rh) : rh(rh) {}
+    iterator(handle rh) : rh(rh) {
+      if (rh)
+        take();
+    }
 
     iterator &operator++() {
-      rh.promise().pull();
-      if (rh.done()) {
-        rh = nullptr;
+      if (++at != last)
+        return *this;
+      // at the end already if pull() throws
+      auto h = std::exchange(rh, nullptr);
+      if (h.promise().pull()) {
+        rh = h;
+        take();
       }
       return *this;
     }
 
-    bool operator!=(iterator const &rhs) { return rh != rhs.rh; }
+    void operator++(int) { ++*this; }
+
+    bool operator==(iterator const &rhs) const { return rh == rhs.rh && (!rh || at == rhs.at); }
+    bool operator==(std::default_sentinel_t) const { return !rh; }
 
-    T const &operator*() { return rh.promise().top()->get(); }
+    reference operator*() const { return *at; }
+
+  private:
+    void take() {
+      auto *top = rh.promise().top();
+      at = top->first;
+      last = at + top->count;
+    }
   };
 
-  iterator begin() {
-    impl.promise().pull();
-    if (impl.done())
-      return { nullptr };
-    return { impl };
-  }
+  /// input iterator over the values in the pieces they were yielded in:
+  /// a yielded span as it is, a single value as a span of one
+  struct chunk_iterator {
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::span<const T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::span<const T>;
+
+    handle rh;
+
+    chunk_iterator() = default;
+    chunk_iterator(handle rh) : rh(rh) {}
+
+    chunk_iterator &operator++() {
+      auto h = std::exchange(rh, nullptr);
+      if (h.promise().pull())
+        rh = h;
+      return *this;
+    }
 
-  iterator end() { return { nullptr }; }
+    void operator++(int) { ++*this; }
+
+    bool operator==(std::default_sentinel_t) const { return !rh; }
+
+    reference operator*() const {
+      auto *top = rh.promise().top();
+      return { top->first, top->count };
+    }
+  };
+
+  /// range of chunk_iterator, it keeps a generator it was made of
+  /// from a temporary, so it can be used in a range-for
+  class chunk_range {
+  public:
+    chunk_iterator begin() { return { gen->start() }; }
+    std::default_sentinel_t end() { return {}; }
+
+  private:
+    friend recursive_generator;
+    explicit chunk_range(recursive_generator *gen) : gen(gen) {}
+    explicit chunk_range(std::unique_ptr<recursive_generator> owned)
+        : owned(std::move(owned)), gen(this->owned.get()) {}
+
+    std::unique_ptr<recursive_generator> owned;
+    recursive_generator *gen;
+  };
+
+  iterator begin() { return { start() }; }
+
+  std::default_sentinel_t end() { return {}; }
+
+  /// iterates the chunks instead of single values, either the one
+  /// or the other can be used with a generator
+  chunk_range chunks() & { return chunk_range{this}; }
+  chunk_range chunks() && {
+    return chunk_range{std::unique_ptr<recursive_generator>(new recursive_generator(std::move(*this)))};
+  }
 
   recursive_generator(recursive_generator const &) = delete;
   recursive_generator &operator=(recursive_generator const &) = delete;
 
-  recursive_generator(recursive_generator &&rhs) : impl(rhs.impl) { rhs.impl = nullptr; }
-  recursive_generator &operator=(recursive_generator &&rhs) = delete;
+  recursive_generator(recursive_generator &&rhs) noexcept : impl(rhs.impl) { rhs.impl = nullptr; }
+  recursive_generator &operator=(recursive_generator &&rhs) noexcept {
+    if (this != &rhs) {
+      destroy_chain();
+      impl = std::exchange(rhs.impl, nullptr);
+    }
+    return *this;
+  }
 
 private:
   recursive_generator(promise_type &p) : impl(handle::from_promise(p)) {}
 
+  // generators still running when a walk is left early are destroyed from
+  // the innermost one out, not recursively from the root
+  void destroy_chain() noexcept {
+    if (!impl)
+      return;
+    auto &root = impl.promise();
+    if (root.is_root()) {
+      for (auto *p = root.top(); p != &root;) {
+        auto *parent = p->prev;
+        auto *owner = p->owner;
+        handle::from_promise(*p).destroy();
+        owner->impl = nullptr;
+        p = parent;
+      }
+    }
+    std::exchange(impl, nullptr).destroy();
+  }
+
+  // runs to the first value, a null handle if there is none
+  handle start() {
+    if (!impl.promise().pull())
+      return nullptr;
+    return impl;
+  }
+
   handle impl;
-};
\ No newline at end of file
+};
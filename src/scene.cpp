@@ -0,0 +1,147 @@
+#include "scene.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+// dirty subtrees bigger than this are re-emitted as separate tasks
+constexpr std::size_t kParallelCutoff = 4096;
+
+void append_circle(std::string &out, float radius)
+{
+  char buf[32];
+  auto res = std::to_chars(buf, buf + sizeof(buf), radius);
+  out += "Circle ";
+  out.append(buf, res.ptr);
+  out += '\n';
+}
+}// namespace
+
+Scene::Scene() { groups.push_back({ "root", 0 }); }
+
+Scene::Node Scene::add_group(std::string name, Node parent)
+{
+  if (parent.kind != Kind::Group) { throw std::invalid_argument("Scene: only groups have children"); }
+
+  Node node{ Kind::Group, static_cast<std::uint32_t>(groups.size()) };
+  groups.push_back({ std::move(name), parent.index });
+  groups[parent.index].children.push_back(node);
+  for (auto g = parent.index;; g = groups[g].parent) {
+    ++groups[g].subtree_size;
+    if (g == 0) { break; }
+  }
+  mark_dirty(parent.index);
+  return node;
+}
+
+Scene::Node Scene::add_circle(float radius, Node parent)
+{
+  if (parent.kind != Kind::Group) { throw std::invalid_argument("Scene: only groups have children"); }
+
+  Node node{ Kind::Circle, static_cast<std::uint32_t>(circles.size()) };
+  circles.push_back({ radius, parent.index });
+  groups[parent.index].children.push_back(node);
+  for (auto g = parent.index;; g = groups[g].parent) {
+    ++groups[g].subtree_size;
+    if (g == 0) { break; }
+  }
+  mark_dirty(parent.index);
+  return node;
+}
+
+void Scene::set_radius(Node circle, float radius)
+{
+  if (circle.kind != Kind::Circle) { throw std::invalid_argument("Scene: only circles have a radius"); }
+
+  auto &cir = circles.at(circle.index);
+  if (cir.radius == radius) { return; }
+  cir.radius = radius;
+  mark_dirty(cir.parent);
+}
+
+void Scene::rename(Node group, std::string name)
+{
+  if (group.kind != Kind::Group) { throw std::invalid_argument("Scene: only groups have a name"); }
+
+  groups.at(group.index).name = std::move(name);
+  mark_dirty(group.index);
+}
+
+void Scene::mark_dirty(std::uint32_t group)
+{
+  // ancestors of a dirty group are dirty already, so we stop there
+  for (;;) {
+    auto &grp = groups[group];
+    if (grp.dirty) { return; }
+    grp.dirty = true;
+    if (group == 0) { return; }
+    group = grp.parent;
+  }
+}
+
+// appends commands of the group to out, old_begin is where they are in the previous frame
+void Scene::emit(std::uint32_t group, std::size_t old_begin, std::string &out, ThreadPool &pool)
+{
+  auto &grp = groups[group];
+  const auto begin = out.size();
+  if (!grp.dirty) {
+    out.append(frame, old_begin, grp.length);
+    return;
+  }
+
+  // big dirty children are emitted on the pool into their own buffers first
+  struct Part
+  {
+    std::uint32_t group;
+    std::string commands{};
+  };
+  std::vector<Part> parts;
+  for (const auto &child : grp.children) {
+    if (child.kind == Kind::Group && groups[child.index].dirty
+        && groups[child.index].subtree_size > kParallelCutoff) {
+      parts.push_back({ child.index });
+    }
+  }
+  if (!parts.empty()) {
+    TaskGroup tasks{ pool };
+    for (auto &part : parts) {
+      tasks.run([this, &pool, &part, old = old_begin + groups[part.group].offset] {
+        emit(part.group, old, part.commands, pool);
+      });
+    }
+    tasks.wait();
+  }
+
+  out += "Group ";
+  out += grp.name;
+  out += " contains:\n";
+  auto part = parts.begin();
+  for (const auto &child : grp.children) {
+    if (child.kind == Kind::Circle) {
+      append_circle(out, circles[child.index].radius);
+      continue;
+    }
+    auto &sub = groups[child.index];
+    const auto old = old_begin + sub.offset;
+    sub.offset = out.size() - begin;
+    if (part != parts.end() && part->group == child.index) {
+      out += part->commands;
+      std::string{}.swap(part->commands);
+      ++part;
+    } else {
+      emit(child.index, old, out, pool);
+    }
+  }
+  grp.length = out.size() - begin;
+  grp.dirty = false;
+}
+
+std::string_view Scene::draw(ThreadPool &pool)
+{
+  if (groups[0].dirty) {
+    std::string next;
+    next.reserve(frame.size());
+    emit(0, 0, next, pool);
+    frame = std::move(next);
+  }
+  return frame;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "thread_pool.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Retained-mode scene graph.
+// Group::draw() visits and prints every object on every frame. Here nodes
+// live in contiguous pools, one per node type, and the commands of the
+// previous frame are kept in one buffer where every group remembers the
+// range of its subtree. A change marks the node's group and its ancestors
+// dirty, so the next frame re-emits changed subtrees only and copies the
+// ranges of the others. Big independent dirty subtrees are re-emitted in
+// parallel, each into a temporary buffer, and spliced in order.
+
+class Scene
+{
+public:
+  enum class Kind : std::uint8_t { Circle, Group };
+
+  struct Node
+  {
+    Kind kind;
+    std::uint32_t index;// into the pool of its kind
+  };
+
+  Scene();
+
+  [[nodiscard]] Node root() const { return { Kind::Group, 0 }; }
+
+  Node add_group(std::string name, Node parent);
+  Node add_circle(float radius, Node parent);
+
+  void set_radius(Node circle, float radius);
+  void rename(Node group, std::string name);
+
+  /// commands of the whole scene, only dirty subtrees are re-emitted
+  std::string_view draw(ThreadPool &pool = ThreadPool::shared());
+
+  [[nodiscard]] std::size_t circles_count() const { return circles.size(); }
+  [[nodiscard]] std::size_t groups_count() const { return groups.size(); }
+
+private:
+  struct CircleNode
+  {
+    float radius;
+    std::uint32_t parent;
+  };
+
+  struct GroupNode
+  {
+    std::string name;
+    std::uint32_t parent;
+    std::vector<Node> children{};
+    bool dirty = true;
+    // commands of the subtree in the frame, valid when not dirty: they start `offset`
+    // bytes after those of the parent, so a copied subtree keeps the offsets inside
+    std::size_t offset = 0;
+    std::size_t length = 0;
+    std::size_t subtree_size = 1;// nodes below and including this group
+  };
+
+  void mark_dirty(std::uint32_t group);
+  void emit(std::uint32_t group, std::size_t old_begin, std::string &out, ThreadPool &pool);
+
+  std::vector<CircleNode> circles;
+  std::vector<GroupNode> groups;
+  std::string frame;// commands of the last drawn frame
+};
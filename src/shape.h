@@ -0,0 +1,321 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// shapes of the decorator examples, in their own namespace
+// because composite has its own (drawable) Circle
+namespace shapes {
+
+/// where format_to() writes: a caller's std::string or any output iterator of char;
+/// pieces of text are passed through a single indirect call, nothing is allocated here
+class Writer
+{
+public:
+  explicit Writer(std::string &out)
+    : target{ &out }, put{ [](void *target, std::string_view text) { static_cast<std::string *>(target)->append(text); } }
+  {}
+
+  template<std::output_iterator<char> It>
+  explicit Writer(It &out)
+    : target{ &out }, put{ [](void *target, std::string_view text) {
+        auto &it = *static_cast<It *>(target);
+        it = std::copy(text.begin(), text.end(), it);
+      } }
+  {}
+
+  Writer &operator<<(std::string_view text)
+  {
+    put(target, text);
+    return *this;
+  }
+
+  /// same digits as `ostream << value` gives by default (%g)
+  Writer &operator<<(float value)
+  {
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6);
+    put(target, { buf, static_cast<std::size_t>(res.ptr - buf) });
+    return *this;
+  }
+
+private:
+  void *target;
+  void (*put)(void *, std::string_view);
+};
+
+template<typename T>
+concept formattable_shape = requires(const T &shape, Writer &out) { shape.format_to(out); };
+
+struct Shape
+{
+  virtual std::string str() const = 0;
+  virtual ~Shape() = default;
+};
+
+struct Circle : Shape
+{
+  float radius;
+
+  explicit Circle(const float radius) : radius(radius) {}
+
+  void resize(float factor) { radius *= factor; }
+
+  std::string str() const override
+  {
+    std::ostringstream oss;
+    oss << "A circle of radius:" << radius;
+    return oss.str();
+  }
+
+  void format_to(Writer &out) const { out << "A circle of radius:" << radius; }
+};
+
+// ---- Dynamic Decorators
+
+struct ColoredShape : Shape
+{
+  Shape &shape;
+  std::string color;
+
+  ColoredShape(Shape &&shape, const std::string &color) : shape(shape), color(color) {}
+
+  std::string str() const override
+  {
+    std::ostringstream oss;
+    oss << shape.str() << " has the color " << color;
+    return oss.str();
+  }
+};
+
+struct TransparentShape : Shape
+{
+  Shape &shape;
+  uint8_t transparency;
+
+  TransparentShape(Shape &&shape, uint8_t transparency) : shape(shape), transparency(transparency) {}
+
+  std::string str() const override
+  {
+    std::ostringstream oss;
+    oss << shape.str() << " has " << static_cast<float>(transparency) / 255.f * 100.f << "% transparency";
+    return oss.str();
+  }
+};
+
+// ---- Value Decorators
+// ColoredShape and TransparentShape keep a reference to the decorated shape,
+// which dangles as soon as it was a temporary, and every str() builds
+// a stream and a string per layer. The decorators below own what they decorate
+// and append their text into one buffer given by the caller.
+
+/// any formattable shape as a copyable value; objects up to kInlineSize bytes
+/// are kept inside, bigger ones on the heap.
+/// A decorator of a ShapeValue (Colored<>, Transparent<>) never fits inline, since
+/// it contains a whole ShapeValue, so it isn't stored as such: the decorated value
+/// is taken over and the decoration alone is added to a flat list of layers
+/// written after the shape.
+class ShapeValue
+{
+public:
+  static constexpr std::size_t kInlineSize = 64;
+
+  ShapeValue() = default;
+
+  template<formattable_shape T>
+    requires(!std::same_as<std::remove_cvref_t<T>, ShapeValue>)
+  ShapeValue(T &&shape)
+  {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (requires(const U &deco) {
+                    requires std::same_as<decltype(U::shape), ShapeValue>;
+                    deco.layer();
+                  }) {
+      *this = std::forward<T>(shape).shape;
+      layers.emplace_back(shape.layer());
+    } else {
+      if constexpr (fits_inline<U>) {
+        object = ::new (buffer) U(std::forward<T>(shape));
+      } else {
+        object = new U(std::forward<T>(shape));
+      }
+      ops = ops_of<U>();
+    }
+  }
+
+  ShapeValue(const ShapeValue &other) : layers(other.layers)
+  {
+    if (other.ops) { other.ops->copy(other, *this); }
+  }
+
+  ShapeValue(ShapeValue &&other) noexcept : layers(std::move(other.layers))
+  {
+    if (other.ops) { other.ops->move(other, *this); }
+  }
+
+  ShapeValue &operator=(const ShapeValue &other)
+  {
+    if (this != &other) { *this = ShapeValue{ other }; }
+    return *this;
+  }
+
+  ShapeValue &operator=(ShapeValue &&other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      if (other.ops) { other.ops->move(other, *this); }
+      layers = std::move(other.layers);
+    }
+    return *this;
+  }
+
+  ~ShapeValue() { reset(); }
+
+  void format_to(Writer &out) const
+  {
+    if (ops) { ops->format(object, out); }
+    for (const auto &layer : layers) { layer.format_to(out); }
+  }
+
+  [[nodiscard]] bool empty() const { return ops == nullptr && layers.empty(); }
+  /// true if the shape didn't fit into the inline buffer
+  [[nodiscard]] bool on_heap() const { return ops && object != static_cast<const void *>(buffer); }
+  /// number of decorations added at run time
+  [[nodiscard]] std::size_t layers_count() const { return layers.size(); }
+
+private:
+  struct Ops
+  {
+    void (*format)(const void *, Writer &);
+    void (*copy)(const ShapeValue &, ShapeValue &);
+    void (*move)(ShapeValue &, ShapeValue &);// leaves the source empty
+    void (*destroy)(ShapeValue &);
+  };
+
+  template<typename T>
+  static constexpr bool fits_inline = sizeof(T) <= kInlineSize && alignof(T) <= alignof(std::max_align_t)
+                                      && std::is_nothrow_move_constructible_v<T>;
+
+  template<typename T> static const Ops *ops_of()
+  {
+    static constexpr Ops ops{
+      [](const void *obj, Writer &out) { static_cast<const T *>(obj)->format_to(out); },
+      [](const ShapeValue &from, ShapeValue &to) {
+        const auto &obj = *static_cast<const T *>(from.object);
+        if constexpr (fits_inline<T>) {
+          to.object = ::new (to.buffer) T(obj);
+        } else {
+          to.object = new T(obj);
+        }
+        to.ops = from.ops;
+      },
+      [](ShapeValue &from, ShapeValue &to) {
+        if constexpr (fits_inline<T>) {
+          auto &obj = *static_cast<T *>(from.object);
+          to.object = ::new (to.buffer) T(std::move(obj));
+          obj.~T();
+        } else {
+          to.object = from.object;
+        }
+        to.ops = from.ops;
+        from.object = nullptr;
+        from.ops = nullptr;
+      },
+      [](ShapeValue &value) {
+        if constexpr (fits_inline<T>) {
+          static_cast<T *>(value.object)->~T();
+        } else {
+          delete static_cast<T *>(value.object);
+        }
+      },
+    };
+    return &ops;
+  }
+
+  void reset()
+  {
+    if (ops) { ops->destroy(*this); }
+    object = nullptr;
+    ops = nullptr;
+  }
+
+  alignas(std::max_align_t) std::byte buffer[kInlineSize];
+  void *object = nullptr;
+  const Ops *ops = nullptr;
+  std::vector<ShapeValue> layers;// innermost first
+};
+
+/// formats nothing: a decorator of NoShape is the decoration alone
+struct NoShape
+{
+  void format_to(Writer &) const {}
+};
+
+/// Decorators are templates over what they decorate, so a stack composed
+/// at compile time is one flat object (Transparent<Colored<Circle>> fits
+/// into a ShapeValue without any heap); Colored<> decorates a ShapeValue
+/// for stacks composed at run time, layer() is what the ShapeValue keeps of it.
+template<formattable_shape Inner = ShapeValue> struct Colored
+{
+  Inner shape;
+  std::string color;
+
+  void format_to(Writer &out) const
+  {
+    shape.format_to(out);
+    out << " has the color " << color;
+  }
+
+  [[nodiscard]] Colored<NoShape> layer() const { return { {}, color }; }
+};
+
+template<formattable_shape Inner = ShapeValue> struct Transparent
+{
+  Inner shape;
+  std::uint8_t transparency;
+
+  void format_to(Writer &out) const
+  {
+    shape.format_to(out);
+    out << " has " << static_cast<float>(transparency) / 255.f * 100.f << "% transparency";
+  }
+
+  [[nodiscard]] Transparent<NoShape> layer() const { return { {}, transparency }; }
+};
+
+template<typename Inner> Colored(Inner, std::string) -> Colored<Inner>;
+template<typename Inner> Transparent(Inner, std::uint8_t) -> Transparent<Inner>;
+
+/// writes the description of a shape through an output iterator, returns the iterator past the end
+template<std::output_iterator<char> It, formattable_shape S> It format_to(It out, const S &shape)
+{
+  Writer writer{ out };
+  shape.format_to(writer);
+  return out;
+}
+
+/// appends the description of a shape to out
+template<formattable_shape S> void format_to(std::string &out, const S &shape)
+{
+  Writer writer{ out };
+  shape.format_to(writer);
+}
+
+template<formattable_shape S> std::string to_string(const S &shape)
+{
+  std::string out;
+  format_to(out, shape);
+  return out;
+}
+
+}// namespace shapes
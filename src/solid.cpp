@@ -1,4 +1,7 @@
 #include "solid.h"
+#include "product_index.h"
+#include "product_table.h"
+#include "spec.h"
 #include <iostream>
 
 std::vector<Product> source()
@@ -64,9 +67,91 @@ void run_solid_from_book_examples()
   for (auto &x : greeny) { std::cout << x.name << "" << std::endl; }
 }
 
+void run_columnar_filter_examples()
+{
+  std::cout << "run_columnar_filter_examples:" << std::endl;
+  auto table = ProductTable::from(source());
+
+  ColorSpecification green(Color::Green);
+  SizeSpecification small(Size::Small);
+  SizeSpecification large(Size::Large);
+  auto largeOrSmall = large || small;
+  auto spec = green && largeOrSmall;
+
+  // we get indexes of rows back, products aren't copied
+  for (auto row : ColumnarFilter::filter(table, spec)) {
+    std::cout << table.name(row) << " is green and large or small" << std::endl;
+  }
+}
+
+void run_compile_time_spec_examples()
+{
+  std::cout << "run_compile_time_spec_examples:" << std::endl;
+  auto all = source();
+
+  // temporaries are fine here, operands are stored by value
+  constexpr auto greenAndLargeOrSmall =
+    spec::color(Color::Green) && (spec::size(Size::Large) || spec::size(Size::Small));
+  for (auto &x : spec::filter(all, greenAndLargeOrSmall)) {
+    std::cout << x.name << " is green and large or small" << std::endl;
+  }
+
+  for (auto &x : spec::filter(all, !spec::color(Color::Green))) {
+    std::cout << x.name << " is not green" << std::endl;
+  }
+
+  // the same specification used by a virtual filter
+  BetterFilter btrflt;
+  auto adapted = spec::erase<Product>(greenAndLargeOrSmall);
+  for (auto &x : btrflt.filter(all, adapted)) {
+    std::cout << x.name << " is found by BetterFilter" << std::endl;
+  }
+}
+
+void run_parallel_filter_examples()
+{
+  std::cout << "run_parallel_filter_examples:" << std::endl;
+  auto all = source();
+  auto isGreen = [](const Product &prd) { return prd.color == Color::Green; };
+
+  for (auto &x : LambdaFilter<Product>::filter(exec::par, all, isGreen)) {
+    std::cout << x.name << " is green (found in parallel)" << std::endl;
+  }
+
+  // nothing is copied into a result vector, we stop after the first match
+  for (auto &x : LambdaFilter<Product>::stream(std::views::all(all), isGreen)) {
+    std::cout << x.name << " is the first green thing" << std::endl;
+    break;
+  }
+}
+
+void run_product_index_examples()
+{
+  std::cout << "run_product_index_examples:" << std::endl;
+  IndexedProductStore store;
+  for (auto &prd : source()) { store.insert(prd); }
+
+  ColorSpecification green(Color::Green);
+  SizeSpecification large(Size::Large);
+  auto notLarge = !large;
+  auto greenNotLarge = green && notLarge;
+
+  for (auto &x : store.filter(greenNotLarge)) { std::cout << x.name << " is green and not large" << std::endl; }
+
+  // indexes follow erase() and insert()
+  auto ids = store.query(green).to_vector();
+  store.erase(ids.front());
+  store.insert({ "Grass", Color::Green, Size::Small });
+  for (auto &x : store.filter(greenNotLarge)) { std::cout << x.name << " is still green and not large" << std::endl; }
+}
+
 // all functions combined
 void run_solid_examples()
 {
   run_general_solid_filter();
   run_solid_from_book_examples();
+  run_columnar_filter_examples();
+  run_compile_time_spec_examples();
+  run_parallel_filter_examples();
+  run_product_index_examples();
 }
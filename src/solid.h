@@ -9,9 +9,17 @@
    • Interface Segregation Principle (ISP)
    • Dependency Inversion Principle (DIP)
 */
+#include "recursive_generator.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <array>
+#include <concepts>
+#include <cstddef>
 #include <functional>
+#include <iterator>
+#include <ranges>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Single Responsibility Principle (SRP) -
@@ -47,6 +55,110 @@ template<typename T> struct LambdaFilter
     }
     return result;
   };
+
+  // the overloads below take any range (a vector, std::span, a view...)
+  // without copying it and a predicate which isn't type-erased
+
+  template<std::ranges::input_range R, std::predicate<const T &> Pred>
+  static std::vector<T> filter(R &&items, Pred pred)
+  {
+    return filter(exec::seq, std::forward<R>(items), std::move(pred));
+  }
+
+  template<std::ranges::input_range R, std::predicate<const T &> Pred>
+  static std::vector<T> filter(exec::sequenced_policy, R &&items, Pred pred)
+  {
+    std::vector<T> result;
+    for (const auto &item : items) {
+      if (pred(item)) { result.push_back(item); }
+    }
+    return result;
+  }
+
+  /// the range is split into chunks filtered on a thread pool, every chunk
+  /// gets its own output buffer and the buffers are merged in order at the end
+  template<std::ranges::random_access_range R, std::predicate<const T &> Pred>
+    requires std::ranges::sized_range<R>
+  static std::vector<T> filter(exec::parallel_policy policy, R &&items, Pred pred)
+  {
+    return filter_chunks(policy.on(), std::ranges::begin(items), std::ranges::size(items), [&](auto first, auto count) {
+      std::vector<T> out;
+      for (std::size_t i = 0; i < count; ++i, ++first) {
+        if (pred(*first)) { out.push_back(*first); }
+      }
+      return out;
+    });
+  }
+
+  /// the predicate is evaluated over a chunk in a separate branch-free pass,
+  /// so simple predicates are vectorized, then matches are copied out
+  template<std::ranges::random_access_range R, std::predicate<const T &> Pred>
+    requires std::ranges::sized_range<R>
+  static std::vector<T> filter(exec::parallel_unsequenced_policy policy, R &&items, Pred pred)
+  {
+    return filter_chunks(policy.on(), std::ranges::begin(items), std::ranges::size(items), [&](auto first, auto count) {
+      std::vector<unsigned char> mask(count);
+      std::size_t found = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        mask[i] = static_cast<unsigned char>(pred(first[static_cast<std::ptrdiff_t>(i)]));
+        found += mask[i];
+      }
+      std::vector<T> out;
+      out.reserve(found);
+      for (std::size_t i = 0; i < count; ++i) {
+        if (mask[i]) { out.push_back(first[static_cast<std::ptrdiff_t>(i)]); }
+      }
+      return out;
+    });
+  }
+
+  /// lazy filtering of a (possibly unbounded) range, matches are produced
+  /// one by one and nothing is materialized.
+  /// An lvalue range is referenced (it must outlive the generator),
+  /// an rvalue one is moved into the coroutine.
+  template<std::ranges::input_range R, std::predicate<const T &> Pred>
+    requires std::ranges::viewable_range<R>
+  static recursive_generator<T> stream(R &&items, Pred pred)
+  {
+    return stream_view(std::views::all(std::forward<R>(items)), std::move(pred));
+  }
+
+private:
+  // items per chunk, smaller chunks don't pay off the scheduling
+  static constexpr std::size_t kMinChunk = 16 * 1024;
+
+  template<std::ranges::view V, typename Pred> static recursive_generator<T> stream_view(V items, Pred pred)
+  {
+    for (const auto &item : items) {
+      if (pred(item)) { co_yield item; }
+    }
+  }
+
+  template<typename It, typename Chunk>
+  static std::vector<T> filter_chunks(ThreadPool &pool, It first, std::size_t size, Chunk chunk)
+  {
+    // a few chunks per thread so idle workers have something to steal
+    std::size_t chunks = std::max<std::size_t>(1, std::min(pool.size() * 4, size / kMinChunk));
+    std::size_t per_chunk = (size + chunks - 1) / chunks;
+
+    std::vector<std::vector<T>> buffers(chunks);
+    TaskGroup group{ pool };
+    for (std::size_t c = 0; c < chunks; ++c) {
+      std::size_t begin = std::min(size, c * per_chunk);
+      std::size_t count = std::min(size, begin + per_chunk) - begin;
+      group.run([&buffers, &chunk, c, begin, count, first] {
+        buffers[c] = chunk(first + static_cast<std::ptrdiff_t>(begin), count);
+      });
+    }
+    group.wait();
+
+    std::size_t total = 0;
+    for (const auto &buf : buffers) { total += buf.size(); }
+    std::vector<T> result;
+    result.reserve(total);
+    for (auto &buf : buffers) { std::move(buf.begin(), buf.end(), std::back_inserter(result)); }
+    return result;
+  }
 };
 
 // ---- solution proposed by the book - Modern C++ Patterns ---->
@@ -55,6 +167,8 @@ template<typename T> struct AndSpecification;
 
 template<typename T> struct OrSpecification;
 
+template<typename T> struct NotSpecification;
+
 template<typename T> struct Specification
 {
   virtual bool is_satisfied(T item) = 0;
@@ -63,6 +177,8 @@ template<typename T> struct Specification
   AndSpecification<T> operator&&(Specification &other) { return AndSpecification<T>(*this, other); }
 
   OrSpecification<T> operator||(Specification &other) { return OrSpecification<T>(*this, other); }
+
+  NotSpecification<T> operator!() { return NotSpecification<T>(*this); }
 };
 
 template<typename T> struct Filter
@@ -122,6 +238,18 @@ template<typename T> struct OrSpecification : Specification<T>
   bool is_satisfied(T item) override { return first.is_satisfied(item) || second.is_satisfied(item); }
 };
 
+template<typename T> struct NotSpecification : Specification<T>
+{
+  Specification<T> &inner;
+
+  explicit NotSpecification(Specification<T> &inner) : inner{ inner } {}
+
+  bool is_satisfied(T item) override { return !inner.is_satisfied(item); }
+};
+
+// NB: the specifications above keep references to their operands,
+// see spec.h for value-type specifications which are combined at compile-time
+
 // So let’s recap what OCP principle is and how the preceding example enforces it.
 // Basically, OCP states that you shouldn’t need to go back to code you’ve already
 // written and tested and change it.
@@ -170,3 +298,4 @@ template<typename T> struct OrSpecification : Specification<T>
 // );
 
 void run_solid_examples();
+void run_solid_benchmarks(std::size_t limit);
@@ -0,0 +1,170 @@
+#include "bench.h"
+#include "product_index.h"
+#include "product_table.h"
+#include "solid.h"
+#include "spec.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<Product> make_catalog(std::size_t rows)
+{
+  std::mt19937 gen{ 42 };
+  std::uniform_int_distribution<int> color(0, 2);
+  std::uniform_int_distribution<int> size(0, 2);
+
+  std::vector<Product> items;
+  items.reserve(rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    items.push_back({ "p" + std::to_string(i), static_cast<Color>(color(gen)), static_cast<Size>(size(gen)) });
+  }
+  return items;
+}
+
+void bench_columnar_filter(std::size_t rows)
+{
+  std::cout << "--- green and (large or small), " << rows << " rows ---\n";
+  auto items = make_catalog(rows);
+  auto table = ProductTable::from(items);
+
+  ColorSpecification green(Color::Green);
+  SizeSpecification large(Size::Large);
+  SizeSpecification small(Size::Small);
+  auto large_or_small = large || small;
+  auto spec = green && large_or_small;
+
+  BetterFilter better;
+  bench::report("BetterFilter", rows, bench::measure_ms([&] { bench::keep(better.filter(items, spec).size()); }, 1));
+
+  bench::report("LambdaFilter",
+    rows,
+    bench::measure_ms(
+      [&] {
+        auto res = LambdaFilter<Product>::filter(items, [](const Product &prd) {
+          return prd.color == Color::Green && (prd.size == Size::Large || prd.size == Size::Small);
+        });
+        bench::keep(res.size());
+      },
+      1));
+
+  bench::report("ColumnarFilter (selection vector)",
+    rows,
+    bench::measure_ms([&] { bench::keep(ColumnarFilter::filter(table, spec).size()); }));
+}
+
+// per item cost of the virtual Specification tree versus the inlined one
+void bench_spec_dispatch(std::size_t rows)
+{
+  std::cout << "--- specification dispatch, " << rows << " rows ---\n";
+  auto items = make_catalog(rows);
+
+  ColorSpecification green(Color::Green);
+  SizeSpecification large(Size::Large);
+  SizeSpecification small(Size::Small);
+  auto large_or_small = large || small;
+  auto virtual_spec = green && large_or_small;
+
+  constexpr auto static_spec = spec::color(Color::Green) && (spec::size(Size::Large) || spec::size(Size::Small));
+  auto adapted = spec::erase<Product>(static_spec);
+
+  auto count_with = [&](Specification<Product> &spec) {
+    std::size_t found = 0;
+    for (const auto &prd : items) { found += spec.is_satisfied(prd); }
+    return found;
+  };
+
+  bench::report("virtual Specification", rows, bench::measure_ms([&] { bench::keep(count_with(virtual_spec)); }));
+  bench::report("spec:: through erase<Product>", rows, bench::measure_ms([&] { bench::keep(count_with(adapted)); }));
+  bench::report("spec:: inlined",
+    rows,
+    bench::measure_ms([&] {
+      std::size_t found = 0;
+      for (const auto &prd : items) { found += static_spec(prd); }
+      bench::keep(found);
+    }));
+}
+
+void bench_parallel_filter(std::size_t rows)
+{
+  std::cout << "--- LambdaFilter policies on " << ThreadPool::shared().size() << " threads, " << rows
+            << " rows ---\n";
+  auto items = make_catalog(rows);
+  auto pred = [](const Product &prd) { return prd.color == Color::Green && prd.size == Size::Large; };
+
+  bench::report("std::function, vector copy",
+    rows,
+    bench::measure_ms([&] { bench::keep(LambdaFilter<Product>::filter(items, std::function<bool(Product)>(pred)).size()); }));
+  bench::report("exec::seq", rows, bench::measure_ms([&] {
+    bench::keep(LambdaFilter<Product>::filter(exec::seq, items, pred).size());
+  }));
+  bench::report("exec::par", rows, bench::measure_ms([&] {
+    bench::keep(LambdaFilter<Product>::filter(exec::par, items, pred).size());
+  }));
+  bench::report("exec::par_unseq", rows, bench::measure_ms([&] {
+    bench::keep(LambdaFilter<Product>::filter(exec::par_unseq, items, pred).size());
+  }));
+  bench::report("stream (count only)", rows, bench::measure_ms([&] {
+    std::size_t found = 0;
+    for (const auto &prd : LambdaFilter<Product>::stream(std::span<const Product>(items), pred)) {
+      found += prd.name.size() != 0;
+    }
+    bench::keep(found);
+  }));
+}
+
+// repeated queries answered from bitmap indexes versus a scan of the catalog
+void bench_product_index(std::size_t rows)
+{
+  std::cout << "--- indexed queries, " << rows << " rows ---\n";
+  auto items = make_catalog(rows);
+  IndexedProductStore store;
+  for (const auto &prd : items) { store.insert(prd); }
+
+  ColorSpecification green(Color::Green);
+  ColorSpecification blue(Color::Blue);
+  SizeSpecification large(Size::Large);
+  auto green_and_large = green && large;
+  auto spec = green_and_large || blue;
+
+  auto scan = [&] {
+    std::size_t found = 0;
+    for (const auto &prd : items) { found += spec.is_satisfied(prd); }
+    return found;
+  };
+  bench::report("linear scan", rows, bench::measure_ms([&] { bench::keep(scan()); }));
+  bench::report("bitmap index query", rows, bench::measure_ms([&] { bench::keep(store.query(spec).cardinality()); }));
+
+  std::mt19937 gen{ 7 };
+  constexpr std::size_t kUpdates = 10'000;
+  bench::report("erase + insert (index upkeep)", kUpdates, bench::measure_ms([&] {
+    for (std::size_t i = 0; i < kUpdates; ++i) {
+      auto row = static_cast<IndexedProductStore::id>(gen() % rows);
+      auto prd = store[row];
+      store.erase(row);
+      store.insert(std::move(prd));
+    }
+  }));
+}
+
+}// namespace
+
+void run_solid_benchmarks(std::size_t limit)
+{
+  constexpr std::size_t kRows[] = { 1'000'000, 10'000'000, 100'000'000 };
+  for (std::size_t rows : kRows) {
+    if (rows > limit) { break; }
+    bench_columnar_filter(rows);
+  }
+  bench_spec_dispatch(std::min<std::size_t>(limit, 10'000'000));
+  bench_parallel_filter(std::min<std::size_t>(limit, 10'000'000));
+  constexpr std::size_t kCatalogs[] = { 10'000, 100'000, 1'000'000, 10'000'000 };
+  for (std::size_t rows : kCatalogs) {
+    if (rows > limit) { break; }
+    bench_product_index(rows);
+  }
+}
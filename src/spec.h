@@ -0,0 +1,130 @@
+#pragma once
+
+#include "solid.h"
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compile-time specifications.
+// Specification<T> from solid.h calls is_satisfied() virtually and
+// And/OrSpecification keep references to their operands, so a composition
+// like green && (large || small) dangles as soon as the temporary dies.
+// Here every specification is a small value type, combinations hold their
+// operands by value and the whole predicate tree is known to the compiler,
+// so it is inlined into the filtering loop:
+//
+//   constexpr auto green_and_big = spec::color(Color::Green) && spec::size(Size::Large);
+//   auto res = spec::filter(products, green_and_big || !spec::color(Color::Blue));
+//
+// To pass such a specification to a virtual Filter<T> wrap it with spec::erase<T>().
+
+namespace spec {
+
+/// base class marking a type as a compile-time specification (CRTP)
+template<typename Derived> struct expression
+{
+};
+
+template<typename S>
+constexpr bool is_spec_v = std::is_base_of_v<expression<std::remove_cvref_t<S>>, std::remove_cvref_t<S>>;
+
+template<typename S>
+concept specification = is_spec_v<S>;
+
+struct color_is : expression<color_is>
+{
+  Color value;
+
+  constexpr explicit color_is(Color value) : value{ value } {}
+
+  template<typename T> constexpr bool operator()(const T &item) const { return item.color == value; }
+};
+
+struct size_is : expression<size_is>
+{
+  Size value;
+
+  constexpr explicit size_is(Size value) : value{ value } {}
+
+  template<typename T> constexpr bool operator()(const T &item) const { return item.size == value; }
+};
+
+template<typename L, typename R> struct and_spec : expression<and_spec<L, R>>
+{
+  L left;
+  R right;
+
+  constexpr and_spec(L left, R right) : left{ std::move(left) }, right{ std::move(right) } {}
+
+  template<typename T> constexpr bool operator()(const T &item) const { return left(item) && right(item); }
+};
+
+template<typename L, typename R> struct or_spec : expression<or_spec<L, R>>
+{
+  L left;
+  R right;
+
+  constexpr or_spec(L left, R right) : left{ std::move(left) }, right{ std::move(right) } {}
+
+  template<typename T> constexpr bool operator()(const T &item) const { return left(item) || right(item); }
+};
+
+template<typename S> struct not_spec : expression<not_spec<S>>
+{
+  S inner;
+
+  constexpr explicit not_spec(S inner) : inner{ std::move(inner) } {}
+
+  template<typename T> constexpr bool operator()(const T &item) const { return !inner(item); }
+};
+
+/// turns any predicate (e.g. a lambda) into a specification
+template<typename F> struct where_spec : expression<where_spec<F>>
+{
+  F fun;
+
+  constexpr explicit where_spec(F fun) : fun{ std::move(fun) } {}
+
+  template<typename T> constexpr bool operator()(const T &item) const { return fun(item); }
+};
+
+constexpr color_is color(Color value) { return color_is{ value }; }
+constexpr size_is size(Size value) { return size_is{ value }; }
+template<typename F> constexpr where_spec<F> where(F fun) { return where_spec<F>{ std::move(fun) }; }
+
+template<specification L, specification R> constexpr auto operator&&(L left, R right)
+{
+  return and_spec<L, R>{ std::move(left), std::move(right) };
+}
+
+template<specification L, specification R> constexpr auto operator||(L left, R right)
+{
+  return or_spec<L, R>{ std::move(left), std::move(right) };
+}
+
+template<specification S> constexpr auto operator!(S inner) { return not_spec<S>{ std::move(inner) }; }
+
+/// filters items by a compile-time specification, the check is inlined
+template<typename T, specification S> std::vector<T> filter(const std::vector<T> &items, const S &spec)
+{
+  std::vector<T> result;
+  for (const auto &item : items) {
+    if (spec(item)) { result.push_back(item); }
+  }
+  return result;
+}
+
+/// adapter which exposes a compile-time specification through the virtual
+/// Specification<T> interface, so it could be passed to any Filter<T>
+template<typename T, specification S> struct erased : Specification<T>
+{
+  S spec;
+
+  explicit erased(S spec) : spec{ std::move(spec) } {}
+
+  bool is_satisfied(T item) override { return spec(item); }
+};
+
+template<typename T, specification S> erased<T, S> erase(S spec) { return erased<T, S>{ std::move(spec) }; }
+
+}// namespace spec
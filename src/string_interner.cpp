@@ -0,0 +1,207 @@
+#include "string_interner.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+constexpr std::size_t kChunkSize = 64 * 1024;
+constexpr std::size_t kInitialSlots = 64;
+constexpr std::size_t kBulkBlock = 4096;
+}// namespace
+
+StringInterner::StringInterner(std::size_t shard_count) : shards(std::bit_ceil(std::max<std::size_t>(1, shard_count)))
+{}
+
+StringInterner::~StringInterner()
+{
+  for (auto &segment : segments) { delete[] segment.load(); }
+}
+
+bool StringInterner::probe(const Shard &shard, std::uint32_t hash, std::string_view text, id &result) const
+{
+  if (shard.slots.empty()) { return false; }
+  const std::size_t mask = shard.slots.size() - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    const auto &slot = shard.slots[pos];
+    if (slot.key_plus_one == 0) { return false; }
+    if (slot.hash == hash && (*this)[slot.key_plus_one - 1] == text) {
+      result = slot.key_plus_one - 1;
+      return true;
+    }
+  }
+}
+
+bool StringInterner::find(std::string_view text, id &result) const
+{
+  auto full = std::hash<std::string_view>{}(text);
+  const auto &shard = shards[shard_of(full)];
+  std::shared_lock lock{ shard.mtx };
+  return probe(shard, static_cast<std::uint32_t>(full), text, result);
+}
+
+StringInterner::id StringInterner::intern(std::string_view text)
+{
+  auto full = std::hash<std::string_view>{}(text);
+  auto hash = static_cast<std::uint32_t>(full);
+  auto &shard = shards[shard_of(full)];
+  shard.interned.fetch_add(1, std::memory_order_relaxed);
+  shard.requested_bytes.fetch_add(text.size(), std::memory_order_relaxed);
+
+  id result = 0;
+  {
+    std::shared_lock lock{ shard.mtx };
+    if (probe(shard, hash, text, result)) { return result; }
+  }
+
+  // somebody could have added it between the locks, insert_or_get finds it then
+  std::unique_lock lock{ shard.mtx };
+  return insert_or_get(shard, hash, text);
+}
+
+void StringInterner::intern_bulk(std::span<const std::string_view> texts, std::span<id> ids)
+{
+  if (ids.size() < texts.size()) { throw std::invalid_argument("StringInterner::intern_bulk: not enough room for ids"); }
+
+  // texts of a block are grouped by shard (a counting sort), so every shard is locked
+  // once per block; blocks keep the texts and ids being worked on in the cache
+  std::vector<std::size_t> hashes(std::min(texts.size(), kBulkBlock));
+  std::vector<std::size_t> order(hashes.size());
+  std::vector<std::size_t> first(shards.size() + 1);
+  std::vector<std::size_t> next(shards.size());
+  for (std::size_t begin = 0; begin < texts.size(); begin += kBulkBlock) {
+    const auto count = std::min(kBulkBlock, texts.size() - begin);
+    std::fill(first.begin(), first.end(), 0);
+    for (std::size_t i = 0; i < count; ++i) {
+      hashes[i] = std::hash<std::string_view>{}(texts[begin + i]);
+      ++first[shard_of(hashes[i]) + 1];
+    }
+    for (std::size_t s = 0; s < shards.size(); ++s) { first[s + 1] += first[s]; }
+    std::copy(first.begin(), first.end() - 1, next.begin());
+    for (std::size_t i = 0; i < count; ++i) { order[next[shard_of(hashes[i])]++] = i; }
+
+    for (std::size_t s = 0; s < shards.size(); ++s) {
+      if (first[s] == first[s + 1]) { continue; }
+      auto &shard = shards[s];
+      std::size_t bytes = 0;
+      std::unique_lock lock{ shard.mtx };
+      // one growth for the whole group instead of several on the way
+      while ((shard.used + first[s + 1] - first[s]) * 2 > shard.slots.size()) { grow(shard); }
+      for (auto k = first[s]; k < first[s + 1]; ++k) {
+        auto i = order[k];
+        auto hash = static_cast<std::uint32_t>(hashes[i]);
+        auto text = texts[begin + i];
+        bytes += text.size();
+        ids[begin + i] = insert_or_get(shard, hash, text);
+      }
+      shard.interned.fetch_add(first[s + 1] - first[s], std::memory_order_relaxed);
+      shard.requested_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+  }
+}
+
+StringInterner::id StringInterner::insert_or_get(Shard &shard, std::uint32_t hash, std::string_view text)
+{
+  // grown before the walk, so the empty slot it ends at is where the text goes
+  if ((shard.used + 1) * 2 > shard.slots.size()) { grow(shard); }
+  const std::size_t mask = shard.slots.size() - 1;
+  auto pos = hash & mask;
+  for (; shard.slots[pos].key_plus_one != 0; pos = (pos + 1) & mask) {
+    const auto &slot = shard.slots[pos];
+    if (slot.hash == hash && (*this)[slot.key_plus_one - 1] == text) { return slot.key_plus_one - 1; }
+  }
+
+  // checked before the increment, so a failed call doesn't wrap the counter and later ones
+  // don't get ids in use; UINT32_MAX is never given out, slots keep id + 1
+  auto result = next_id.load(std::memory_order_relaxed);
+  do {
+    if (result == UINT32_MAX) { throw std::length_error("StringInterner: out of ids"); }
+  } while (!next_id.compare_exchange_weak(result, result + 1, std::memory_order_relaxed));
+  publish(result, store(shard, text));
+  shard.slots[pos] = { hash, result + 1 };
+  ++shard.used;
+  shard.unique_bytes += text.size();
+  count.fetch_add(1, std::memory_order_release);
+  return result;
+}
+
+std::string_view StringInterner::store(Shard &shard, std::string_view text)
+{
+  if (text.empty()) { return {}; }
+  // long strings get a chunk of their own, so the current one isn't wasted
+  if (text.size() > kChunkSize / 4) {
+    shard.chunks.push_back(std::make_unique<char[]>(text.size()));
+    shard.arena_bytes += text.size();
+    std::memcpy(shard.chunks.back().get(), text.data(), text.size());
+    return { shard.chunks.back().get(), text.size() };
+  }
+  if (shard.chunk_left < text.size()) {
+    shard.chunks.push_back(std::make_unique<char[]>(kChunkSize));
+    shard.current = shard.chunks.back().get();
+    shard.chunk_left = kChunkSize;
+    shard.arena_bytes += kChunkSize;
+  }
+  char *dst = shard.current;
+  std::memcpy(dst, text.data(), text.size());
+  shard.current += text.size();
+  shard.chunk_left -= text.size();
+  return { dst, text.size() };
+}
+
+void StringInterner::publish(id key, std::string_view text)
+{
+  auto [segment, offset] = locate(key);
+  auto *views = segments[segment].load(std::memory_order_acquire);
+  if (!views) {
+    // the first thread to need the segment allocates it
+    auto *fresh = new std::string_view[std::size_t{ 1 } << (segment + kFirstSegmentBits)];
+    if (segments[segment].compare_exchange_strong(views, fresh, std::memory_order_acq_rel)) {
+      views = fresh;
+    } else {
+      delete[] fresh;
+    }
+  }
+  views[offset] = text;
+}
+
+void StringInterner::grow(Shard &shard)
+{
+  std::vector<Slot> bigger(std::max(kInitialSlots, shard.slots.size() * 2));
+  const std::size_t mask = bigger.size() - 1;
+  for (const auto &slot : shard.slots) {
+    if (slot.key_plus_one == 0) { continue; }
+    auto pos = slot.hash & mask;
+    while (bigger[pos].key_plus_one != 0) { pos = (pos + 1) & mask; }
+    bigger[pos] = slot;
+  }
+  shard.slots = std::move(bigger);
+}
+
+std::size_t StringInterner::memory_usage() const
+{
+  std::size_t bytes = 0;
+  for (const auto &shard : shards) {
+    std::shared_lock lock{ shard.mtx };
+    bytes += shard.arena_bytes + shard.slots.capacity() * sizeof(Slot);
+  }
+  for (std::size_t s = 0; s < segments.size(); ++s) {
+    if (segments[s].load()) { bytes += (std::size_t{ 1 } << (s + kFirstSegmentBits)) * sizeof(std::string_view); }
+  }
+  return bytes;
+}
+
+StringInterner::stats StringInterner::statistics() const
+{
+  stats total;
+  for (const auto &shard : shards) {
+    std::shared_lock lock{ shard.mtx };
+    total.unique += shard.used;
+    total.interned += shard.interned.load(std::memory_order_relaxed);
+    total.unique_bytes += shard.unique_bytes;
+    total.requested_bytes += shard.requested_bytes.load(std::memory_order_relaxed);
+  }
+  return total;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Thread-safe string interning.
+// Every distinct string gets a small integer id and is stored once, in an
+// append-only arena, so the string_view of an id stays valid as long as the
+// interner lives. id -> string is an index into a dense table (segments which
+// are never moved, so reading it needs no lock); string -> id is an open
+// addressing hash table split into shards, each behind its own shared_mutex:
+// lookups of known strings take a shard shared, only new strings take it
+// exclusively. intern_bulk() locks every shard once per block of the batch.
+
+class StringInterner
+{
+public:
+  using id = std::uint32_t;
+
+  struct stats
+  {
+    std::size_t unique = 0;// distinct strings
+    std::size_t interned = 0;// calls of intern, one per string for intern_bulk
+    std::size_t unique_bytes = 0;// characters stored
+    std::size_t requested_bytes = 0;// characters passed in
+    /// what storing every requested string separately would take more
+    [[nodiscard]] std::size_t bytes_saved() const { return requested_bytes - unique_bytes; }
+  };
+
+  explicit StringInterner(std::size_t shards = 64);
+  ~StringInterner();
+
+  StringInterner(const StringInterner &) = delete;
+  StringInterner &operator=(const StringInterner &) = delete;
+
+  /// id of the text, added if it's new
+  id intern(std::string_view text);
+  /// interns texts[i] into ids[i]
+  void intern_bulk(std::span<const std::string_view> texts, std::span<id> ids);
+  /// id of the text if it was interned
+  [[nodiscard]] bool find(std::string_view text, id &result) const;
+
+  /// the interned string, valid as long as the interner; the id has to come from this interner
+  [[nodiscard]] std::string_view operator[](id key) const
+  {
+    auto [segment, offset] = locate(key);
+    return segments[segment].load(std::memory_order_acquire)[offset];
+  }
+
+  [[nodiscard]] std::size_t size() const { return count.load(std::memory_order_acquire); }
+  /// bytes held: strings, hash tables and the id table
+  [[nodiscard]] std::size_t memory_usage() const;
+  [[nodiscard]] stats statistics() const;
+
+private:
+  // segment k of the id table holds kFirstSegment << k views
+  static constexpr std::size_t kFirstSegmentBits = 10;
+  static constexpr std::size_t kSegments = 32 - kFirstSegmentBits + 1;
+
+  struct Slot
+  {
+    std::uint32_t hash;
+    std::uint32_t key_plus_one;// 0 for an empty slot
+  };
+
+  struct alignas(64) Shard
+  {
+    mutable std::shared_mutex mtx;
+    std::vector<Slot> slots;
+    std::size_t used = 0;
+    // arena of this shard: strings are copied into chunks which never move
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char *current = nullptr;
+    std::size_t chunk_left = 0;
+    std::size_t arena_bytes = 0;
+    // statistics, the first two are counted under the shared lock too
+    std::atomic<std::size_t> interned{ 0 };
+    std::atomic<std::size_t> requested_bytes{ 0 };
+    std::size_t unique_bytes = 0;
+  };
+
+  static std::pair<std::size_t, std::size_t> locate(id key)
+  {
+    auto pos = static_cast<std::uint64_t>(key) + (1ULL << kFirstSegmentBits);
+    auto segment = static_cast<std::size_t>(std::bit_width(pos) - 1 - kFirstSegmentBits);
+    return { segment, pos - (1ULL << (segment + kFirstSegmentBits)) };
+  }
+
+  [[nodiscard]] std::size_t shard_of(std::size_t full_hash) const
+  {
+    return (std::uint64_t{ full_hash } >> 32) & (shards.size() - 1);
+  }
+  bool probe(const Shard &shard, std::uint32_t hash, std::string_view text, id &result) const;
+  /// id of the text, added if it isn't in the shard; one walk of the probe sequence ends at the
+  /// text or at the empty slot it goes to. The shard is locked exclusively
+  id insert_or_get(Shard &shard, std::uint32_t hash, std::string_view text);
+  std::string_view store(Shard &shard, std::string_view text);
+  void publish(id key, std::string_view text);
+  static void grow(Shard &shard);
+
+  std::vector<Shard> shards;
+  std::array<std::atomic<std::string_view *>, kSegments> segments{};
+  std::atomic<std::uint32_t> next_id{ 0 };
+  std::atomic<std::uint32_t> count{ 0 };
+};
@@ -0,0 +1,228 @@
+#include "string_pool.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = { 'S', 'T', 'R', 'P', 'O', 'O', 'L', '\0' };
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kMaxStrings = std::size_t{ 1 } << 30;
+
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t count;
+  std::uint32_t slots;
+  std::uint32_t reserved;
+  std::uint64_t blob_size;
+};
+
+constexpr std::size_t align8(std::size_t size) { return (size + 7) / 8 * 8; }
+
+// where the parts of a file with `count` strings and `slots` index slots start
+struct Layout
+{
+  std::size_t offsets, index, blob;
+
+  Layout(std::size_t count, std::size_t slots)
+    : offsets{ sizeof(Header) }, index{ offsets + align8((count + 1) * sizeof(std::uint32_t)) },
+      blob{ index + slots * sizeof(string_pool::slot) }
+  {}
+};
+
+}// namespace
+
+void string_pool::write(const std::string &path, std::span<const std::string_view> strings)
+{
+  std::size_t blob_size = 0;
+  for (auto text : strings) { blob_size += text.size(); }
+  // the index is twice as big as the number of strings and has 2^31 slots at most
+  if (strings.size() > kMaxStrings || blob_size > UINT32_MAX) {
+    throw std::length_error("string_pool::write: too many strings for 32-bit offsets");
+  }
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.count = static_cast<std::uint32_t>(strings.size());
+  header.slots = static_cast<std::uint32_t>(std::bit_ceil(std::max<std::size_t>(16, strings.size() * 2)));
+  header.blob_size = blob_size;
+
+  std::vector<std::uint32_t> offsets;
+  offsets.reserve(strings.size() + 1);
+  offsets.push_back(0);
+  std::vector<string_pool::slot> index(header.slots);
+  const std::uint32_t mask = header.slots - 1;
+  for (std::uint32_t i = 0; i < header.count; ++i) {
+    offsets.push_back(offsets.back() + static_cast<std::uint32_t>(strings[i].size()));
+    auto hash = static_cast<std::uint32_t>(string_pool::hash(strings[i]));
+    auto pos = hash & mask;
+    while (index[pos].key_plus_one != 0) { pos = (pos + 1) & mask; }
+    index[pos] = { hash, i + 1 };
+  }
+  offsets.resize(align8(offsets.size() * sizeof(std::uint32_t)) / sizeof(std::uint32_t), 0);
+
+  // written next to the target and renamed, so readers never see half a file
+  auto tmp = path + ".tmp";
+  {
+    std::ofstream out{ tmp, std::ios::binary | std::ios::trunc };
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(offsets.data()),
+      static_cast<std::streamsize>(offsets.size() * sizeof(std::uint32_t)));
+    out.write(reinterpret_cast<const char *>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(string_pool::slot)));
+    for (auto text : strings) { out.write(text.data(), static_cast<std::streamsize>(text.size())); }
+    if (!out.flush()) { throw std::runtime_error("string_pool::write: can't write " + tmp); }
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) { throw std::runtime_error("string_pool::write: can't rename " + tmp); }
+}
+
+#ifndef _WIN32
+
+namespace {
+[[noreturn]] void throw_errno(const char *what) { throw std::system_error(errno, std::generic_category(), what); }
+}// namespace
+
+MappedStringPool::MappedStringPool(std::string path) : path{ std::move(path) }, overlay{ std::make_unique<StringInterner>(16) }
+{
+  map();
+}
+
+MappedStringPool::~MappedStringPool() { unmap(); }
+
+void MappedStringPool::map()
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) { throw_errno("MappedStringPool: open"); }
+  struct stat info{};
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw_errno("MappedStringPool: fstat");
+  }
+  mapped_size = static_cast<std::size_t>(info.st_size);
+  if (mapped_size < sizeof(Header)) {
+    ::close(fd);
+    throw std::runtime_error("MappedStringPool: " + path + " is too small");
+  }
+  void *addr = ::mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) { throw_errno("MappedStringPool: mmap"); }
+  mapped = addr;
+
+  const auto *base = static_cast<const char *>(mapped);
+  Header header{};
+  std::memcpy(&header, base, sizeof(header));
+  Layout layout{ header.count, header.slots };
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+      || !std::has_single_bit(header.slots) || header.slots <= header.count
+      || layout.blob + header.blob_size != mapped_size) {
+    unmap();
+    throw std::runtime_error("MappedStringPool: " + path + " isn't a string pool");
+  }
+
+  file_count = header.count;
+  slot_count = header.slots;
+  offsets = reinterpret_cast<const std::uint32_t *>(base + layout.offsets);
+  slots = reinterpret_cast<const string_pool::slot *>(base + layout.index);
+  blob = base + layout.blob;
+  if (!valid(header.blob_size)) {
+    unmap();
+    throw std::runtime_error("MappedStringPool: " + path + " is corrupt");
+  }
+}
+
+bool MappedStringPool::valid(std::uint64_t blob_size) const
+{
+  // every string is inside the blob
+  if (offsets[0] != 0 || offsets[file_count] != blob_size) { return false; }
+  for (std::uint32_t i = 0; i < file_count; ++i) {
+    if (offsets[i + 1] < offsets[i]) { return false; }
+  }
+  // slots refer to strings of the file and there is an empty one to stop probing at
+  std::uint32_t used = 0;
+  for (std::uint32_t i = 0; i < slot_count; ++i) {
+    if (slots[i].key_plus_one > file_count) { return false; }
+    used += slots[i].key_plus_one != 0;
+  }
+  return used < slot_count;
+}
+
+void MappedStringPool::unmap()
+{
+  if (mapped) { ::munmap(mapped, mapped_size); }
+  mapped = nullptr;
+  file_count = 0;
+}
+
+bool MappedStringPool::find_in_file(std::string_view text, id &result) const
+{
+  auto hash = static_cast<std::uint32_t>(string_pool::hash(text));
+  const std::uint32_t mask = slot_count - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    const auto &slot = slots[pos];
+    if (slot.key_plus_one == 0) { return false; }
+    if (slot.hash == hash && (*this)[slot.key_plus_one - 1] == text) {
+      result = slot.key_plus_one - 1;
+      return true;
+    }
+  }
+}
+
+bool MappedStringPool::find(std::string_view text, id &result) const
+{
+  if (find_in_file(text, result)) { return true; }
+  if (overlay->find(text, result)) {
+    result += file_count;
+    return true;
+  }
+  return false;
+}
+
+MappedStringPool::id MappedStringPool::intern(std::string_view text)
+{
+  id result = 0;
+  if (find_in_file(text, result)) { return result; }
+  return file_count + overlay->intern(text);
+}
+
+void MappedStringPool::compact()
+{
+  std::vector<std::string_view> all;
+  all.reserve(size());
+  for (id key = 0; key < size(); ++key) { all.push_back((*this)[key]); }
+  string_pool::write(path, all);
+
+  // the new file is mapped before the old one is released: `all` points into it, and if
+  // mapping throws the pool stays as it was
+  MappedStringPool fresh{ path };
+  swap(fresh);
+}
+
+void MappedStringPool::swap(MappedStringPool &other) noexcept
+{
+  std::swap(mapped, other.mapped);
+  std::swap(mapped_size, other.mapped_size);
+  std::swap(file_count, other.file_count);
+  std::swap(offsets, other.offsets);
+  std::swap(slots, other.slots);
+  std::swap(slot_count, other.slot_count);
+  std::swap(blob, other.blob);
+  std::swap(overlay, other.overlay);
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "string_interner.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Interned strings stored in a file which is used as it is, right after mmap.
+// Layout (native byte order, every part starts at a multiple of 8):
+//   header   magic, version, number of strings, number of index slots, blob size
+//   offsets  count + 1 uint32, string i is blob[offsets[i], offsets[i + 1])
+//   index    open addressing table of {hash, id + 1} slots (0 is empty),
+//            at most half full, linear probing from hash & (slots - 1)
+//   blob     all strings one after another
+// Nothing is parsed or allocated on open: the offsets and the index are only
+// checked in one pass, so a corrupt file can't make lookups read past it.
+// Strings which aren't in the file go to an in-memory overlay with ids
+// following the file's ones; compact() writes the file again with the
+// overlay included, ids don't change.
+
+namespace string_pool {
+
+/// hash used by the index, fixed so files are portable between builds (FNV-1a)
+constexpr std::uint64_t hash(std::string_view text)
+{
+  std::uint64_t value = 0xcbf29ce484222325ULL;
+  for (char c : text) {
+    value ^= static_cast<unsigned char>(c);
+    value *= 0x100000001b3ULL;
+  }
+  return value;
+}
+
+/// slot of the index
+struct slot
+{
+  std::uint32_t hash;// low bits of hash()
+  std::uint32_t key_plus_one;// 0 for an empty slot
+};
+
+/// writes strings (which have to be distinct) as a pool file, string i gets id i
+void write(const std::string &path, std::span<const std::string_view> strings);
+
+}// namespace string_pool
+
+#ifndef _WIN32
+
+class MappedStringPool
+{
+public:
+  using id = std::uint32_t;
+
+  /// maps a file written by string_pool::write(), throws if it isn't one
+  explicit MappedStringPool(std::string path);
+  ~MappedStringPool();
+
+  MappedStringPool(const MappedStringPool &) = delete;
+  MappedStringPool &operator=(const MappedStringPool &) = delete;
+
+  /// id of the text, a new one goes into the overlay; safe from many threads
+  id intern(std::string_view text);
+  [[nodiscard]] bool find(std::string_view text, id &result) const;
+
+  /// views into the file are valid until compact() or destruction
+  [[nodiscard]] std::string_view operator[](id key) const
+  {
+    if (key < file_count) { return { blob + offsets[key], offsets[key + 1] - offsets[key] }; }
+    return (*overlay)[key - file_count];
+  }
+
+  [[nodiscard]] std::size_t size() const { return file_count + overlay->size(); }
+  [[nodiscard]] std::size_t file_size() const { return file_count; }
+  [[nodiscard]] std::size_t overlay_size() const { return overlay->size(); }
+
+  /// rewrites the file with the overlay strings and maps it again,
+  /// must not run together with other calls
+  void compact();
+
+private:
+  void map();
+  void unmap();
+  void swap(MappedStringPool &other) noexcept;
+  bool find_in_file(std::string_view text, id &result) const;
+  [[nodiscard]] bool valid(std::uint64_t blob_size) const;
+
+  std::string path;
+  void *mapped = nullptr;
+  std::size_t mapped_size = 0;
+  std::uint32_t file_count = 0;
+  const std::uint32_t *offsets = nullptr;
+  const string_pool::slot *slots = nullptr;
+  std::uint32_t slot_count = 0;
+  const char *blob = nullptr;
+  std::unique_ptr<StringInterner> overlay;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "thread_pool.h"
+
+namespace {
+// pool and queue of the worker running in the current thread
+thread_local ThreadPool *current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+}// namespace
+
+ThreadPool::ThreadPool(std::size_t threads)
+{
+  queues.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) { queues.push_back(std::make_unique<Queue>()); }
+  workers.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([this, i] { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock{ sleep_mtx };
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &thr : workers) { thr.join(); }
+}
+
+ThreadPool &ThreadPool::shared()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::submit(task tsk)
+{
+  std::size_t idx =
+    current_pool == this ? current_queue : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+  // counted before it's visible, so pending never drops below zero
+  bool has_helpers = false;
+  {
+    std::lock_guard<std::mutex> lock{ sleep_mtx };
+    pending.fetch_add(1, std::memory_order_relaxed);
+    has_helpers = helpers.load(std::memory_order_relaxed) > 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock{ queues[idx]->mtx };
+    queues[idx]->tasks.push_back(std::move(tsk));
+  }
+  wake.notify_one();
+  if (has_helpers) { progress.notify_all(); }
+}
+
+bool ThreadPool::pop(std::size_t idx, task &tsk)
+{
+  auto &queue = *queues[idx];
+  std::lock_guard<std::mutex> lock{ queue.mtx };
+  if (queue.tasks.empty()) { return false; }
+  tsk = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, task &tsk)
+{
+  for (std::size_t i = 1; i <= queues.size(); ++i) {
+    auto &queue = *queues[(thief + i) % queues.size()];
+    std::lock_guard<std::mutex> lock{ queue.mtx };
+    if (!queue.tasks.empty()) {
+      tsk = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::run_one()
+{
+  task tsk;
+  bool found = current_pool == this ? pop(current_queue, tsk) || steal(current_queue, tsk) : steal(0, tsk);
+  if (!found) { return false; }
+  pending.fetch_sub(1, std::memory_order_relaxed);
+  tsk();
+
+  // the task may have made the condition of a sleeping help_until() true
+  if (helpers.fetch_add(0, std::memory_order_acq_rel) > 0) {
+    { std::lock_guard<std::mutex> lock{ sleep_mtx }; }
+    progress.notify_all();
+  }
+  return true;
+}
+
+void ThreadPool::work(std::size_t idx)
+{
+  current_pool = this;
+  current_queue = idx;
+  for (;;) {
+    if (run_one()) { continue; }
+
+    std::unique_lock<std::mutex> lock{ sleep_mtx };
+    wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_relaxed) > 0; });
+    // queued tasks are drained first, a TaskGroup waiting for them would never finish otherwise
+    if (stopping && pending.load(std::memory_order_relaxed) == 0) { return; }
+  }
+}
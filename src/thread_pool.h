@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool.
+// Every worker owns a queue: it takes its own tasks from the back (LIFO keeps
+// the freshest, cache-hot work local) and, when the queue is empty, steals
+// from the front of other queues. A thread waiting for its tasks doesn't
+// block, it executes pending tasks instead, which makes nested fork-join
+// (tasks spawning tasks and waiting for them) deadlock free.
+// Tasks still queued when the pool is destroyed are run before the workers exit.
+
+class ThreadPool
+{
+public:
+  using task = std::function<void()>;
+
+  explicit ThreadPool(std::size_t threads = std::max(1U, std::thread::hardware_concurrency()));
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  [[nodiscard]] std::size_t size() const { return workers.size(); }
+
+  /// schedules a task, tasks submitted from a worker go to its own queue
+  void submit(task tsk);
+
+  /// runs one pending task in the calling thread, returns false if there was none
+  bool run_one();
+
+  /// executes pending tasks until done() returns true,
+  /// sleeps while there is nothing to run and done() is still false
+  template<typename Pred> void help_until(Pred done)
+  {
+    while (!done()) {
+      if (run_one()) { continue; }
+
+      std::unique_lock<std::mutex> lock{ sleep_mtx };
+      // pairs with the read-modify-write in run_one(): either the task which makes
+      // done() true sees us waiting, or we see its result here
+      helpers.fetch_add(1, std::memory_order_acq_rel);
+      progress.wait(lock, [&] { return done() || pending.load(std::memory_order_relaxed) > 0; });
+      helpers.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  /// pool shared by the whole program (created on first use)
+  static ThreadPool &shared();
+
+private:
+  struct Queue
+  {
+    std::mutex mtx;
+    std::deque<task> tasks;
+  };
+
+  bool pop(std::size_t idx, task &tsk);
+  bool steal(std::size_t thief, task &tsk);
+  void work(std::size_t idx);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<std::size_t> next_queue{ 0 };
+  std::atomic<std::size_t> pending{ 0 };
+  std::mutex sleep_mtx;
+  std::condition_variable wake;
+  // threads sleeping in help_until(), woken when a task is submitted or finished
+  std::condition_variable progress;
+  std::atomic<std::size_t> helpers{ 0 };
+  bool stopping = false;
+};
+
+/// set of tasks which are waited for together, the first exception
+/// thrown by any of them is rethrown from wait()
+class TaskGroup
+{
+public:
+  explicit TaskGroup(ThreadPool &pool = ThreadPool::shared()) : pool(pool) {}
+  ~TaskGroup() { pool.help_until([this] { return left.load(std::memory_order_acquire) == 0; }); }
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  template<typename F> void run(F &&fun)
+  {
+    left.fetch_add(1, std::memory_order_relaxed);
+    pool.submit([this, fun = std::forward<F>(fun)]() mutable {
+      try {
+        fun();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock{ mtx };
+        if (!error) { error = std::current_exception(); }
+      }
+      left.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  void wait()
+  {
+    pool.help_until([this] { return left.load(std::memory_order_acquire) == 0; });
+    if (error) { std::rethrow_exception(std::exchange(error, nullptr)); }
+  }
+
+private:
+  ThreadPool &pool;
+  std::atomic<std::size_t> left{ 0 };
+  std::mutex mtx;
+  std::exception_ptr error;
+};
+
+// Execution policies, named after the std::execution ones.
+// The standard policies need a parallel backend (TBB for libstdc++)
+// which isn't among our dependencies, so the parallel ones run on a ThreadPool.
+namespace exec {
+
+struct sequenced_policy
+{
+};
+
+struct parallel_policy
+{
+  ThreadPool *pool = nullptr;
+
+  [[nodiscard]] ThreadPool &on() const { return pool ? *pool : ThreadPool::shared(); }
+  parallel_policy operator()(ThreadPool &other) const { return { &other }; }
+};
+
+/// like parallel_policy, but the work inside a chunk may be vectorized too
+struct parallel_unsequenced_policy
+{
+  ThreadPool *pool = nullptr;
+
+  [[nodiscard]] ThreadPool &on() const { return pool ? *pool : ThreadPool::shared(); }
+  parallel_unsequenced_policy operator()(ThreadPool &other) const { return { &other }; }
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+inline constexpr parallel_unsequenced_policy par_unseq{};
+
+}// namespace exec
@@ -0,0 +1,112 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "bitmap.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+// ids spread over a few containers, some of them dense
+std::set<std::uint32_t> random_ids(std::mt19937 &rng, std::size_t count, std::uint32_t limit)
+{
+  std::uniform_int_distribution<std::uint32_t> any{ 0, limit - 1 };
+  std::set<std::uint32_t> ids;
+  while (ids.size() < count) { ids.insert(any(rng)); }
+  return ids;
+}
+
+Bitmap bitmap_of(const std::set<std::uint32_t> &ids)
+{
+  Bitmap bmp;
+  for (auto id : ids) { bmp.add(id); }
+  return bmp;
+}
+
+std::vector<std::uint32_t> vector_of(const std::set<std::uint32_t> &ids) { return { ids.begin(), ids.end() }; }
+
+}// namespace
+
+TEST_CASE("Bitmap set operations match std::set ones", "[bitmap]")
+{
+  std::mt19937 rng{ 7 };
+  // 4 containers: 30'000 ids make most of them dense, 2'000 keep them sparse
+  for (std::size_t lhs_count : { 2'000U, 30'000U }) {
+    for (std::size_t rhs_count : { 2'000U, 30'000U }) {
+      const auto lhs_ids = random_ids(rng, lhs_count, 4 << 16);
+      const auto rhs_ids = random_ids(rng, rhs_count, 4 << 16);
+      const auto lhs = bitmap_of(lhs_ids);
+      const auto rhs = bitmap_of(rhs_ids);
+      REQUIRE(lhs.cardinality() == lhs_ids.size());
+      REQUIRE(lhs.to_vector() == vector_of(lhs_ids));
+
+      std::vector<std::uint32_t> expected;
+      std::set_intersection(
+        lhs_ids.begin(), lhs_ids.end(), rhs_ids.begin(), rhs_ids.end(), std::back_inserter(expected));
+      REQUIRE((lhs & rhs).to_vector() == expected);
+
+      expected.clear();
+      std::set_union(lhs_ids.begin(), lhs_ids.end(), rhs_ids.begin(), rhs_ids.end(), std::back_inserter(expected));
+      REQUIRE((lhs | rhs).to_vector() == expected);
+
+      expected.clear();
+      std::set_difference(
+        lhs_ids.begin(), lhs_ids.end(), rhs_ids.begin(), rhs_ids.end(), std::back_inserter(expected));
+      REQUIRE(and_not(lhs, rhs).to_vector() == expected);
+    }
+  }
+}
+
+TEST_CASE("Bitmap adds, removes and looks up ids", "[bitmap]")
+{
+  Bitmap bmp;
+  REQUIRE(bmp.empty());
+  bmp.add(5);
+  bmp.add(5);
+  bmp.add(70'000);
+  REQUIRE(bmp.cardinality() == 2);
+  REQUIRE(bmp.contains(5));
+  REQUIRE(bmp.contains(70'000));
+  REQUIRE_FALSE(bmp.contains(6));
+
+  bmp.remove(6);
+  bmp.remove(5);
+  REQUIRE(bmp.to_vector() == std::vector<std::uint32_t>{ 70'000 });
+  bmp.remove(70'000);
+  REQUIRE(bmp.empty());
+}
+
+TEST_CASE("Bitmap container converts with hysteresis", "[bitmap]")
+{
+  Bitmap bmp;
+  for (std::uint32_t id = 0; id < Bitmap::kMaxArray; ++id) { bmp.add(id * 2); }
+  REQUIRE(bmp.dense_containers() == 0);
+  bmp.add(1);
+  REQUIRE(bmp.dense_containers() == 1);
+
+  // going back and forth around the array limit keeps the container dense
+  for (int i = 0; i < 10; ++i) {
+    bmp.remove(1);
+    bmp.remove(2);
+    REQUIRE(bmp.dense_containers() == 1);
+    bmp.add(1);
+    bmp.add(2);
+  }
+  REQUIRE(bmp.cardinality() == Bitmap::kMaxArray + 1);
+
+  std::uint32_t id = 0;
+  while (bmp.cardinality() >= Bitmap::kMinDense) {
+    REQUIRE(bmp.dense_containers() == 1);
+    bmp.remove(id);
+    id += 2;
+  }
+  REQUIRE(bmp.dense_containers() == 0);
+  REQUIRE(bmp.cardinality() == Bitmap::kMinDense - 1);
+  REQUIRE(bmp.contains(1));
+  REQUIRE(bmp.contains(id));
+  REQUIRE_FALSE(bmp.contains(id - 2));
+}
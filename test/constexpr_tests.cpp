@@ -1,8 +1,28 @@
 #include <catch2/catch_test_macros.hpp>
 
 // #include <patterns/sample_library.hpp>
+#include "spec.h"
 
 TEST_CASE("Factorials are computed with constexpr", "[factorial]")
 {
   // STATIC_REQUIRE(factorial_constexpr(0) == 1);
 }
+
+TEST_CASE("Specifications are combined and evaluated with constexpr", "[spec]")
+{
+  // Product has a std::string, any type with color and size members will do
+  struct Item
+  {
+    Color color;
+    Size size;
+  };
+  constexpr Item tree{ Color::Green, Size::Large };
+  constexpr auto green = spec::color(Color::Green);
+  constexpr auto small = spec::size(Size::Small);
+
+  STATIC_REQUIRE((green && spec::size(Size::Large))(tree));
+  STATIC_REQUIRE_FALSE((green && small)(tree));
+  STATIC_REQUIRE((small || green)(tree));
+  STATIC_REQUIRE((!small)(tree));
+  STATIC_REQUIRE_FALSE((!(small || green))(tree));
+}
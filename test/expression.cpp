@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "expression.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// a node type the compiler doesn't know, it's called back at run time
+struct Constant : Expression
+{
+  double eval() override { return 100; }
+  void collect(std::vector<double> &v) override { v.push_back(100); }
+};
+
+// 1 + (2 + (3 + ... + count)), as deep as it is long
+std::shared_ptr<Expression> right_deep(int count)
+{
+  std::shared_ptr<Expression> tree = std::make_shared<Literal>(count);
+  for (int i = count - 1; i > 0; --i) { tree = std::make_shared<AdditionExpression>(std::make_shared<Literal>(i), tree); }
+  return tree;
+}
+
+}// namespace
+
+TEST_CASE("ExpressionProgram computes what the tree does", "[composite]")
+{
+  auto tree = std::make_shared<AdditionExpression>(std::make_shared<Literal>(2),
+    std::make_shared<AdditionExpression>(std::make_shared<Literal>(3), std::make_shared<Constant>()));
+  auto program = ExpressionProgram::compile(*tree);
+
+  REQUIRE(program.max_stack == 3);
+  REQUIRE(program.literals == std::vector<double>{ 2, 3 });
+  REQUIRE(program.run() == tree->eval());
+  // the value stack is reused, results of the previous run don't leak into the next one
+  REQUIRE(program.run(std::vector<double>{ 10, 20 }) == 130);
+  REQUIRE(program.run() == 105);
+  REQUIRE_THROWS_AS(program.run(std::vector<double>{ 1 }), std::invalid_argument);
+}
+
+TEST_CASE("ExpressionProgram stack is sized by the depth of the tree", "[composite]")
+{
+  constexpr int kDepth = 20'000;
+  auto tree = right_deep(kDepth);
+  auto program = ExpressionProgram::compile(*tree);
+
+  REQUIRE(program.max_stack == kDepth);
+  REQUIRE(program.run() == static_cast<double>(kDepth) * (kDepth + 1) / 2);
+}
+
+TEST_CASE("ExpressionProgram::run_batch gives the results of run() per set", "[composite]")
+{
+  auto tree = right_deep(4);
+  auto program = ExpressionProgram::compile(*tree);
+
+  // more sets than in one block, values of slot s are bindings[s * kSets, (s + 1) * kSets)
+  constexpr std::size_t kSets = 1'000;
+  std::vector<double> bindings(4 * kSets);
+  for (std::size_t s = 0; s < 4; ++s) {
+    for (std::size_t i = 0; i < kSets; ++i) { bindings[s * kSets + i] = static_cast<double>(s * i); }
+  }
+  std::vector<double> out(kSets);
+  program.run_batch(bindings, out);
+
+  for (std::size_t i = 0; i < kSets; ++i) {
+    std::vector<double> one{ bindings[i], bindings[kSets + i], bindings[2 * kSets + i], bindings[3 * kSets + i] };
+    REQUIRE(out[i] == program.run(one));
+  }
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "expression_dag.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("ExpressionDag keeps one node per distinct subexpression", "[composite]")
+{
+  ExpressionDag dag;
+  auto a = dag.input(1);
+  auto b = dag.input(2);
+  REQUIRE(a != b);
+
+  auto sum = dag.add(a, b);
+  REQUIRE(dag.add(a, b) == sum);
+  // addition is commutative
+  REQUIRE(dag.add(b, a) == sum);
+  REQUIRE(dag.constant(2) == dag.constant(2));
+  REQUIRE(dag.constant(2) != dag.constant(3));
+  // 2 inputs, 1 sum and 2 constants
+  REQUIRE(dag.size() == 5);
+}
+
+TEST_CASE("ExpressionDag imports equal subtrees as one node", "[composite]")
+{
+  // (2 + 3) + (3 + 2), both halves are separate objects
+  AdditionExpression tree{ std::make_shared<AdditionExpression>(std::make_shared<Literal>(2), std::make_shared<Literal>(3)),
+    std::make_shared<AdditionExpression>(std::make_shared<Literal>(3), std::make_shared<Literal>(2)) };
+
+  ExpressionDag dag;
+  auto root = dag.import(tree);
+  // constants 2 and 3, their sum and the sum of the sum with itself
+  REQUIRE(dag.size() == 4);
+  REQUIRE(dag.value(root) == tree.eval());
+}
+
+TEST_CASE("ExpressionDag imports literals as inputs", "[composite]")
+{
+  auto shared = std::make_shared<Literal>(5);
+  AdditionExpression tree{ shared, std::make_shared<AdditionExpression>(std::make_shared<Literal>(5), shared) };
+
+  ExpressionDag dag;
+  std::vector<ExpressionDag::id> inputs;
+  auto root = dag.import(tree, &inputs);
+  // the shared literal is one input, the equal one is another
+  REQUIRE(inputs.size() == 2);
+  REQUIRE(dag.value(root) == 15);
+
+  dag.set(inputs[0], 10);
+  REQUIRE(dag.value(root) == 25);
+}
+
+TEST_CASE("ExpressionDag recomputes only what a change reaches", "[composite]")
+{
+  ExpressionDag dag;
+  auto a = dag.input(1);
+  auto b = dag.input(2);
+  auto c = dag.input(3);
+  auto ab = dag.add(a, b);
+  auto total = dag.add(ab, c);
+  auto other = dag.add(b, c);
+  REQUIRE(dag.value(total) == 6);
+
+  SECTION("a change goes up to the root")
+  {
+    dag.set(a, 5);
+    REQUIRE(dag.value(total) == 10);
+    REQUIRE(dag.recomputed() == 2);
+    REQUIRE(dag.value(other) == 5);
+  }
+  SECTION("a sum which didn't change stops the propagation")
+  {
+    dag.set(a, 2);
+    dag.set(b, 1);
+    REQUIRE(dag.value(total) == 6);
+    // a + b and b + c, but not the root
+    REQUIRE(dag.recomputed() == 2);
+    REQUIRE(dag.value(other) == 4);
+  }
+  SECTION("setting the same value changes nothing")
+  {
+    dag.set(c, 3);
+    REQUIRE(dag.value(total) == 6);
+    REQUIRE(dag.recomputed() == 0);
+  }
+  SECTION("a node shared by two users is recomputed once")
+  {
+    auto twice = dag.add(ab, ab);
+    dag.set(a, 11);
+    REQUIRE(dag.value(twice) == 26);
+    REQUIRE(dag.value(total) == 16);
+    // a + b, (a + b) + c and (a + b) + (a + b)
+    REQUIRE(dag.recomputed() == 3);
+  }
+}
+
+TEST_CASE("ExpressionDag rejects unknown nodes", "[composite]")
+{
+  ExpressionDag dag;
+  auto a = dag.input(1);
+  auto two = dag.constant(2);
+  REQUIRE_THROWS_AS(dag.add(a, 42), std::out_of_range);
+  REQUIRE_THROWS_AS(dag.value(42), std::out_of_range);
+  REQUIRE_THROWS_AS(dag.set(two, 3), std::invalid_argument);
+  REQUIRE_THROWS_AS(dag.set(dag.add(a, two), 3), std::invalid_argument);
+}
@@ -1,5 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include "flyweight_policies.h"
+#include "formatted_text.h"
+
 #include <iostream>
 #include <string>
 #include <vector>
@@ -7,6 +10,8 @@
 #include <sstream>
 #include <map>
 #include <algorithm>
+#include <latch>
+#include <thread>
 
 
 using namespace std;
@@ -68,3 +73,107 @@ TEST_CASE("FlyweightEvaluation", "[initial]")
 
     REQUIRE("alpha BETA gamma" == s.str());
 }
+
+TEST_CASE("FormattedTextWords", "[formatted_text]")
+{
+    FormattedText text{"alpha beta gamma"};
+    text.format_word(1, capitalize);
+
+    REQUIRE("alpha BETA gamma" == text.render());
+    REQUIRE(text.str() == "alpha beta gamma");
+}
+
+TEST_CASE("FormattedTextRanges", "[formatted_text]")
+{
+    FormattedText text{"one two three four"};
+    text.format(0, 7, capitalize);
+    text.format(4, 13, bold);
+    REQUIRE("ONE **TWO three** four" == text.render());
+
+    // clearing the middle splits the bold run, putting the flags back merges the runs again
+    text.clear(7, 8, bold);
+    REQUIRE("ONE **TWO** **three** four" == text.render());
+    text.format(7, 8, bold);
+    REQUIRE("ONE **TWO three** four" == text.render());
+    REQUIRE(text.run_count() == 4);
+
+    text.clear(0, text.size(), capitalize | bold);
+    REQUIRE(text.run_count() == 1);
+    REQUIRE(text.render() == text.str());
+}
+
+TEST_CASE("FormattedTextNesting", "[formatted_text]")
+{
+    FormattedText text{"a b c"};
+    text.format(0, 5, italic);
+    text.format(2, 3, bold);
+    REQUIRE("_a _**_b_**_ c_" == text.render());
+    REQUIRE(text.rendered_size() == text.render().size());
+    REQUIRE((text.flags_at(2) == (bold | italic)));
+}
+
+TEST_CASE("FormattedTextUppercase", "[formatted_text]")
+{
+    // long enough for the vector loop and its tail, with bytes around a..z and outside ASCII
+    string input;
+    for (int c = 0; c < 256; ++c) { input += static_cast<char>(c); }
+    FormattedText text{input};
+    text.format(0, text.size(), capitalize);
+
+    string expected = input;
+    for (auto& c : expected) { if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A'); }
+    REQUIRE(expected == text.render());
+}
+
+namespace {
+// every thread creates users of the same few names and tells where its
+// "name0" is stored; the threads end together, so thread local values
+// are all alive when the addresses are compared
+template<typename User> std::vector<const std::string *> names_from_threads()
+{
+  constexpr std::size_t kThreads = 4;
+  constexpr std::size_t kUsers = 5'000;
+  std::vector<std::string> names;
+  for (int i = 0; i < 50; ++i) { names.push_back("name" + std::to_string(i)); }
+
+  std::vector<const std::string *> first_name(kThreads);
+  std::vector<char> correct(kThreads);
+  std::latch done{ kThreads };
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<User> users;
+      bool ok = true;
+      for (std::size_t i = 0; i < kUsers; ++i) {
+        const auto &first = names[(i + t) % names.size()];
+        const auto &last = names[(i * 7) % names.size()];
+        users.emplace_back(first, last);
+        ok = ok && users.back().first_name.get() == first && users.back().last_name.get() == last;
+      }
+      // within a thread equal names are stored once
+      ok = ok && &users[names.size()].first_name.get() == &users[0].first_name.get();
+      correct[t] = ok;
+      first_name[t] = &User{ "name0", "name0" }.first_name.get();
+      done.arrive_and_wait();
+    });
+  }
+  for (auto &thread : threads) { thread.join(); }
+  REQUIRE(std::all_of(correct.begin(), correct.end(), [](char ok) { return ok != 0; }));
+  return first_name;
+}
+}// namespace
+
+TEST_CASE("FlyweightPoliciesFromThreads", "[flyweight]")
+{
+  auto same = [](const std::vector<const std::string *> &values) {
+    return std::all_of(values.begin(), values.end(), [&](auto *value) { return value == values.front(); });
+  };
+  REQUIRE(same(names_from_threads<User2>()));
+  REQUIRE(same(names_from_threads<UntrackedUser2>()));
+  REQUIRE(same(names_from_threads<ShardedUser2>()));
+
+  // every thread has values of its own
+  auto local = names_from_threads<ThreadLocalUser2>();
+  std::sort(local.begin(), local.end());
+  REQUIRE(std::adjacent_find(local.begin(), local.end()) == local.end());
+}
@@ -0,0 +1,155 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "function_decorator.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace decorators;
+
+namespace {
+// records entering and leaving the decorated call
+struct tracing
+{
+  std::vector<std::string> *trace;
+  std::string name;
+
+  template<typename Next, typename... Args> decltype(auto) operator()(Next &&next, Args &&...args)
+  {
+    trace->push_back(name + " in");
+    decorators::on_exit done{ [this] { trace->push_back(name + " out"); } };
+    return next(std::forward<Args>(args)...);
+  }
+};
+}// namespace
+
+TEST_CASE("Decorators keep results and arguments as they are", "[decorators]")
+{
+  call_stats stats;
+  std::vector<int> items{ 1, 2, 3 };
+
+  auto at = decorate([&items](std::size_t i) -> int & { return items[i]; }, counting{ &stats }, timing{ &stats });
+  at(1) = 20;
+  REQUIRE(items[1] == 20);
+
+  int sum = 0;
+  auto consume = decorate([&sum](std::unique_ptr<int> value) { sum += *value; }, counting{ &stats });
+  consume(std::make_unique<int>(5));
+  REQUIRE(sum == 5);
+  REQUIRE(stats.calls == 2);
+}
+
+TEST_CASE("Decorators run in order and see exceptions", "[decorators]")
+{
+  std::vector<std::string> trace;
+  auto traced = decorate([&trace](bool fails) {
+    trace.emplace_back("call");
+    if (fails) { throw std::runtime_error{ "no" }; }
+  }, tracing{ &trace, "outer" }, tracing{ &trace, "inner" });
+  const std::vector<std::string> expected{ "outer in", "inner in", "call", "inner out", "outer out" };
+  traced(false);
+  REQUIRE(trace == expected);
+  trace.clear();
+  REQUIRE_THROWS_AS(traced(true), std::runtime_error);
+  REQUIRE(trace == expected);
+
+  call_stats stats;
+  auto fail = decorate([]() -> int { throw std::runtime_error{ "no" }; }, counting{ &stats }, timing{ &stats });
+  REQUIRE_THROWS_AS(fail(), std::runtime_error);
+  REQUIRE(stats.calls == 1);
+
+  int calls = 0;
+  auto twice = decorate([&calls](int x) {
+    ++calls;
+    return 2 * x;
+  }, caching<int(int)>{});
+  REQUIRE(twice(3) == 6);
+  REQUIRE(twice(3) == 6);
+  REQUIRE(twice(4) == 8);
+  REQUIRE(calls == 2);
+}
+
+TEST_CASE("Memoized function is bounded and counts hits", "[decorators]")
+{
+  int calls = 0;
+  // one shard, so the capacity is exact
+  auto square = decorate([&calls](int x) {
+    ++calls;
+    return x * x;
+  }, memoizing<int(int)>{ 2, 1 });
+
+  REQUIRE(square(2) == 4);
+  REQUIRE(square(3) == 9);
+  REQUIRE(square(2) == 4);
+  REQUIRE(square(4) == 16);// evicts 3, the least recently used
+  REQUIRE(square(2) == 4);
+  REQUIRE(square(3) == 9);
+  REQUIRE(calls == 4);
+
+  auto stats = square.get<0>().stats();
+  REQUIRE(stats.hits == 2);
+  REQUIRE(stats.misses == 4);
+  REQUIRE(stats.evictions == 2);
+}
+
+TEST_CASE("Memoized function with the default shards keeps no more than its capacity", "[decorators]")
+{
+  for (std::size_t capacity : { 1U, 2U, 5U, 100U }) {
+    int calls = 0;
+    auto twice = make_memoized<int(int)>([&calls](int x) {
+      ++calls;
+      return 2 * x;
+    }, capacity);
+    REQUIRE(twice.get<0>().cache->shards() <= capacity);
+
+    constexpr int kKeys = 1000;
+    for (int x = 0; x < kKeys; ++x) { REQUIRE(twice(x) == 2 * x); }
+
+    // every miss stores a value and every eviction drops one
+    auto stats = twice.get<0>().stats();
+    REQUIRE(calls == kKeys);
+    REQUIRE(stats.misses == kKeys);
+    REQUIRE(stats.misses - stats.evictions == capacity);
+  }
+}
+
+TEST_CASE("Logging every 0th call logs nothing", "[decorators]")
+{
+  auto quiet = decorate([](int x) { return x + 1; }, logging{ "quiet", 0 });
+  REQUIRE(quiet(1) == 2);
+  REQUIRE(quiet.get<0>().calls == 0);
+}
+
+TEST_CASE("Concurrent misses of a memoized function compute once", "[decorators]")
+{
+  constexpr int kThreads = 8;
+  std::atomic<int> calls{ 0 };
+  memoizing<int(int)> memo{ 16 };
+  auto slow_square = decorate([&](int x) {
+    ++calls;
+    // holds the first caller until all the others wait for its result
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+    while (memo.stats().coalesced < kThreads - 1 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    return x * x;
+  }, memo);
+
+  std::vector<int> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] { results[static_cast<std::size_t>(t)] = slow_square(7); });
+  }
+  for (auto &thread : threads) { thread.join(); }
+
+  REQUIRE(calls == 1);
+  REQUIRE(results == std::vector<int>(kThreads, 49));
+  auto stats = memo.stats();
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.coalesced == kThreads - 1);
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "html.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+// remembers only how much was written
+struct CountingSink
+{
+  std::size_t bytes = 0;
+  std::size_t writes = 0;
+
+  void write(std::string_view data)
+  {
+    bytes += data.size();
+    ++writes;
+  }
+};
+
+struct StringSink
+{
+  std::string out;
+
+  void write(std::string_view data) { out += data; }
+};
+}// namespace
+
+TEST_CASE("StreamingHtmlBuilder writes the same markup as HtmlElement", "[html]")
+{
+  StringSink sink;
+  StreamingHtmlBuilder builder{ sink, "ul" };
+  builder.add_child("li", "hello").open("li").add_child("b", "world").close();
+  builder.finish();
+
+  REQUIRE(sink.out == "<ul>\n<li>hello</li>\n<li>\n<b>world</b>\n</li>\n</ul>\n");
+}
+
+TEST_CASE("StreamingHtmlBuilder memory is O(depth)", "[html]")
+{
+  constexpr std::size_t kElements = 10'000'000;
+  constexpr std::size_t kThreshold = 4096;
+  constexpr std::string_view kItem = "<li>item</li>\n";
+
+  CountingSink sink;
+  std::size_t max_depth = 0;
+  std::size_t max_buffer = 0;
+  {
+    StreamingHtmlBuilder builder{ sink, "html", kThreshold };
+    builder.open("body").open("ul");
+    for (std::size_t i = 0; i < kElements; ++i) {
+      if (i > 0 && i % 1000 == 0) { builder.close().open("ul"); }
+      builder.add_child("li", "item");
+      max_depth = std::max(max_depth, builder.depth());
+      max_buffer = std::max(max_buffer, builder.buffered_capacity());
+    }
+  }
+
+  // html > body > ul
+  REQUIRE(max_depth == 3);
+  // the buffer is reserved once and doesn't grow with the document
+  REQUIRE(max_buffer <= 2 * kThreshold);
+  REQUIRE(sink.bytes > kElements * kItem.size());
+  REQUIRE(sink.writes >= sink.bytes / kThreshold);
+}
+
+TEST_CASE("StreamingHtmlBuilder destructor doesn't throw sink errors", "[html]")
+{
+  struct FailingSink
+  {
+    void write(std::string_view) { throw std::runtime_error("disk full"); }
+  } sink;
+
+  {
+    StreamingHtmlBuilder builder{ sink, "ul" };
+    builder.add_child("li", "lost");
+    REQUIRE_THROWS_AS(builder.finish(), std::runtime_error);
+  }
+  {
+    StreamingHtmlBuilder builder{ sink, "ul" };
+    builder.add_child("li", "lost");
+  }
+}
+
+TEST_CASE("StreamingHtmlBuilder rejects elements after finish()", "[html]")
+{
+  StringSink sink;
+  StreamingHtmlBuilder builder{ sink, "ul" };
+  builder.add_child("li", "hello");
+  builder.finish();
+
+  REQUIRE_THROWS_AS(builder.add_child("li", "late"), std::logic_error);
+  REQUIRE_THROWS_AS(builder.open("li"), std::logic_error);
+  // finishing twice is harmless and nothing was appended after the first one
+  builder.finish();
+  REQUIRE(sink.out == "<ul>\n<li>hello</li>\n</ul>\n");
+}
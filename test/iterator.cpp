@@ -0,0 +1,156 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "arena_tree.h"
+#include "binary_tree.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// tree of `count` nodes numbered from `first` in order, split at random places
+Node<int> *random_nodes(int first, int count, std::mt19937 &rng)
+{
+  if (count == 0) { return nullptr; }
+  int left = std::uniform_int_distribution<int>{ 0, count - 1 }(rng);
+  auto *left_nodes = random_nodes(first, left, rng);
+  auto *right_nodes = random_nodes(first + left + 1, count - left - 1, rng);
+  return new Node<int>{ first + left, left_nodes, right_nodes };
+}
+
+// hash of a sequence: associative, but the order of the parts matters
+struct SequenceHash
+{
+  std::uint64_t hash = 0;
+  std::uint64_t power = 1;
+};
+
+SequenceHash hash_of(int value) { return { static_cast<std::uint64_t>(value) + 1, 1'000'003 }; }
+SequenceHash join(SequenceHash lhs, SequenceHash rhs) { return { lhs.hash * rhs.power + rhs.hash, lhs.power * rhs.power }; }
+
+std::vector<int> sequential(BinaryTree<int> &tree, tree_order order)
+{
+  std::vector<int> values;
+  switch (order) {
+  case tree_order::in_order:
+    for (auto it = tree.begin(); it != tree.end(); ++it) { values.push_back((*it).value); }
+    break;
+  case tree_order::post_order:
+    for (auto *node : tree.post_order()) { values.push_back(node->value); }
+    break;
+  case tree_order::pre_order: {
+    std::vector<Node<int> *> pending{ tree.root };
+    while (!pending.empty()) {
+      auto *node = pending.back();
+      pending.pop_back();
+      if (!node) { continue; }
+      values.push_back(node->value);
+      pending.push_back(node->right);
+      pending.push_back(node->left);
+    }
+  } break;
+  }
+  return values;
+}
+
+}// namespace
+
+TEST_CASE("ArenaTree walks in the order of BinaryTree", "[iterator]")
+{
+  BinaryTree<std::string> pointers{ new Node<std::string>{ "me",
+    new Node<std::string>{ "mother", new Node<std::string>{ "mother's mother" }, nullptr },
+    new Node<std::string>{ "father", nullptr, new Node<std::string>{ "father's father" } } } };
+
+  ArenaTree<std::string> arena;
+  auto mother = arena.add("mother", arena.add("mother's mother"));
+  arena.add("me", mother, arena.add("father", ArenaTree<std::string>::none, arena.add("father's father")));
+
+  std::vector<std::string> expected, walked;
+  for (auto it = pointers.begin(); it != pointers.end(); ++it) { expected.push_back((*it).value); }
+  for (const auto &name : arena) { walked.push_back(name); }
+  REQUIRE(walked == expected);
+
+  for (auto layout : { tree_layout::depth_first, tree_layout::eytzinger, tree_layout::van_emde_boas }) {
+    auto moved = arena.relayout(layout);
+    REQUIRE(moved.root() == 0);
+    REQUIRE(std::vector<std::string>(moved.begin(), moved.end()) == expected);
+  }
+}
+
+TEST_CASE("ArenaTree layouts keep the search tree", "[iterator]")
+{
+  for (std::size_t count : { 0U, 1U, 2U, 7U, 100U, 1000U }) {
+    std::vector<int> sorted(count);
+    std::iota(sorted.begin(), sorted.end(), 0);
+
+    auto eytzinger = ArenaTree<int>::from_sorted(sorted);
+    // a complete tree in breadth first order needs no links to find the children
+    for (ArenaTree<int>::index i = 0; i < eytzinger.size(); ++i) {
+      REQUIRE((eytzinger[i].left == ArenaTree<int>::none || eytzinger[i].left == 2 * i + 1));
+      REQUIRE((eytzinger[i].right == ArenaTree<int>::none || eytzinger[i].right == 2 * i + 2));
+    }
+
+    for (auto layout : { tree_layout::eytzinger, tree_layout::depth_first, tree_layout::van_emde_boas }) {
+      auto tree = ArenaTree<int>::from_sorted(sorted, layout);
+      REQUIRE(std::vector<int>(tree.begin(), tree.end()) == sorted);
+      for (int key : sorted) { REQUIRE(tree[tree.find(key)].value == key); }
+      REQUIRE(tree.find(-1) == ArenaTree<int>::none);
+      REQUIRE(tree.find(static_cast<int>(count)) == ArenaTree<int>::none);
+    }
+  }
+}
+
+TEST_CASE("Parallel traversals of BinaryTree match the sequential ones", "[iterator]")
+{
+  ThreadPool pool{ 4 };
+  std::mt19937 rng{ 7 };
+  BinaryTree<int> random{ random_nodes(0, 20'000, rng) };
+  REQUIRE(random.root->size == 20'000);
+
+  Node<int> *chain = nullptr;
+  for (int i = 0; i < 5'000; ++i) { chain = new Node<int>{ i, chain, nullptr }; }
+  BinaryTree<int> degenerate{ chain };
+
+  for (auto *tree : { &random, &degenerate }) {
+    const auto count = tree->root->size;
+    for (auto order : { tree_order::pre_order, tree_order::in_order, tree_order::post_order }) {
+      auto expected = sequential(*tree, order);
+
+      // a small cutoff, so there are many tasks
+      std::vector<int> placed(count, -1);
+      tree->parallel_for_each(order, [&placed](Node<int> &node, std::size_t at) { placed[at] = node.value; }, pool, 16);
+      REQUIRE(placed == expected);
+
+      auto hash = tree->parallel_reduce(order, SequenceHash{}, [](const Node<int> &node) { return hash_of(node.value); },
+        join, pool, 16);
+      auto expected_hash = std::accumulate(expected.begin(), expected.end(), SequenceHash{},
+        [](SequenceHash acc, int value) { return join(acc, hash_of(value)); });
+      REQUIRE(hash.hash == expected_hash.hash);
+
+      auto evens = tree->parallel_reduce(order, std::size_t{ 0 },
+        [](const Node<int> &node) -> std::size_t { return node.value % 2 == 0; }, std::plus<>{}, pool, 16);
+      REQUIRE(evens == (count + 1) / 2);
+    }
+
+    // parents are visited before their children in pre_order, after them in post_order
+    for (auto order : { tree_order::pre_order, tree_order::post_order }) {
+      std::atomic<int> clock{ 0 };
+      tree->parallel_for_each(order, [&clock](Node<int> &node, std::size_t) { node.value = clock++; }, pool, 16);
+      bool parents_first = true, parents_last = true;
+      for (auto it = tree->begin(); it != tree->end(); ++it) {
+        auto &node = *it;
+        for (auto *child : { node.left, node.right }) {
+          if (!child) { continue; }
+          parents_first = parents_first && node.value < child->value;
+          parents_last = parents_last && node.value > child->value;
+        }
+      }
+      REQUIRE((order == tree_order::pre_order ? parents_first : parents_last));
+    }
+  }
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "chatroom.h"
+#include "person.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+Person quiet(const std::string &name)
+{
+  Person p{ name };
+  p.session = nullptr;
+  return p;
+}
+
+std::vector<std::string> lines(const Person &p)
+{
+  std::vector<std::string> result;
+  for (const auto &line : p.chat_log) { result.push_back(*line); }
+  return result;
+}
+
+}// namespace
+
+TEST_CASE("ChatRoom routes private messages after leaving and rejoining", "[mediator]")
+{
+  ChatRoom room;
+  auto john = quiet("john");
+  auto jane = quiet("jane");
+  auto simon = quiet("simon");
+  room.join(&john);
+  room.join(&jane);
+  room.join(&simon);
+
+  jane.pm("simon", "hi");
+  room.leave(&simon);
+  REQUIRE(room.size() == 2);
+  REQUIRE(simon.room == nullptr);
+  jane.pm("simon", "lost");
+  room.join(&simon);
+  john.pm("simon", "back");
+  john.pm("jane", "hello");
+
+  REQUIRE(lines(simon) == std::vector<std::string>{ "jane: \"hi\"", "john: \"back\"" });
+  REQUIRE(lines(jane).back() == "john: \"hello\"");
+
+  // one broadcast line is shared by everyone but the sender
+  john.say("all of you");
+  REQUIRE(lines(john).back() != "john: \"all of you\"");
+  REQUIRE(jane.chat_log.back() == simon.chat_log.back());
+  REQUIRE(jane.chat_log.back().use_count() == 2);
+}
+
+TEST_CASE("ChatRoom keeps private messages of a name while somebody has it", "[mediator]")
+{
+  ChatRoom room;
+  auto sender = quiet("sender");
+  auto first = quiet("alex");
+  auto second = quiet("alex");
+  room.join(&sender);
+  room.join(&first);
+  room.join(&second);
+
+  sender.pm("alex", "one");
+  room.leave(&first);
+  sender.pm("alex", "two");
+  REQUIRE(first.chat_log.size() + second.chat_log.size() == 3);// and the join of the second alex
+  REQUIRE(*second.chat_log.back() == "sender: \"two\"");
+
+  room.leave(&second);
+  sender.pm("alex", "three");
+  REQUIRE(*second.chat_log.back() == "sender: \"two\"");
+}
+
+TEST_CASE("ChatRoom forgets the names of people who left", "[mediator]")
+{
+  ChatRoom room;
+  auto stays = quiet("stays");
+  room.join(&stays);
+  for (int i = 0; i < 100'000; ++i) {
+    auto visitor = quiet("visitor" + std::to_string(i));
+    room.join(&visitor);
+    room.leave(&visitor);
+  }
+  REQUIRE(room.size() == 1);
+  REQUIRE(room.known_names() <= 2 * 1024);
+
+  auto other = quiet("other");
+  room.join(&other);
+  other.pm("stays", "still here?");
+  REQUIRE(*stays.chat_log.back() == "other: \"still here?\"");
+}
+
+TEST_CASE("ChatRoom ignores joining twice and moves people between rooms", "[mediator]")
+{
+  ChatRoom lobby;
+  ChatRoom kitchen;
+  auto john = quiet("john");
+  auto jane = quiet("jane");
+  lobby.join(&john);
+  lobby.join(&jane);
+  lobby.join(&jane);
+  std::vector<Person *> again{ &john, &jane };
+  lobby.join(again);
+  REQUIRE(lobby.size() == 2);
+  REQUIRE(lines(john) == std::vector<std::string>{ "room: \"jane joins the chat\"" });
+
+  kitchen.join(&jane);
+  REQUIRE(lobby.size() == 1);
+  REQUIRE(kitchen.size() == 1);
+  REQUIRE(jane.room == &kitchen);
+  john.pm("jane", "lost");
+  REQUIRE(jane.chat_log.empty());
+  lobby.leave(&jane);
+  REQUIRE(kitchen.size() == 1);
+}
+
+TEST_CASE("ChatRoom keeps a name reachable while its holders leave in any order", "[mediator]")
+{
+  ChatRoom room;
+  auto sender = quiet("sender");
+  room.join(&sender);
+  std::vector<Person> alexes;
+  alexes.reserve(6);
+  std::vector<Person> others;
+  others.reserve(6);
+  for (int i = 0; i < 6; ++i) {
+    alexes.push_back(quiet("alex"));
+    room.join(&alexes.back());
+    others.push_back(quiet("other" + std::to_string(i)));
+    room.join(&others.back());
+  }
+
+  for (std::size_t i : { 2U, 5U, 0U, 4U, 1U }) {
+    room.leave(&others[i]);
+    room.leave(&alexes[i]);
+    auto text = "left " + std::to_string(i);
+    sender.pm("alex", text);
+    std::size_t got = 0;
+    for (const auto &alex : alexes) {
+      got += alex.room && !alex.chat_log.empty() && *alex.chat_log.back() == "sender: \"" + text + "\"";
+    }
+    REQUIRE(got == 1);
+  }
+  REQUIRE(*alexes[3].chat_log.back() == "sender: \"left 1\"");
+  room.leave(&alexes[3]);
+  sender.pm("alex", "nobody");
+  REQUIRE(*alexes[3].chat_log.back() == "sender: \"left 1\"");
+  REQUIRE(room.size() == 2);
+}
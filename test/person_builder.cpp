@@ -0,0 +1,42 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "person_builder.h"
+
+#include <string>
+
+TEST_CASE("PersonBatch records outlive later additions", "[builder]")
+{
+  PersonBatch batch;
+  auto first = batch.add().lives().at("123 London Road").in("London").works().at("PragmaSoft").earning(10).build();
+  for (int i = 0; i < 10'000; ++i) {
+    batch.add().lives().at(std::to_string(i)).in("Munich").works().at("Rathaus").build();
+  }
+
+  REQUIRE(batch.size() == 10'001);
+  REQUIRE(first.street_address == "123 London Road");
+  REQUIRE(first.city == "London");
+  REQUIRE(first.annual_income == 10);
+  REQUIRE(batch[0].company_name == "PragmaSoft");
+  REQUIRE(batch[10'000].street_address == "9999");
+  REQUIRE(batch[10'000].position.empty());
+}
+
+TEST_CASE("PersonBatch builders started one after another don't share fields", "[builder]")
+{
+  PersonBatch batch;
+  auto john = batch.add().lives().at("1 Baker Street").in("London");
+  auto jane = batch.add().lives().at("2 Marienplatz").in("Munich");
+  auto johns = john.works().at("PragmaSoft").earning(100).build();
+  auto janes = jane.works().at("Rathaus").build();
+
+  REQUIRE(johns.street_address == "1 Baker Street");
+  REQUIRE(johns.city == "London");
+  REQUIRE(johns.company_name == "PragmaSoft");
+  REQUIRE(johns.annual_income == 100);
+  REQUIRE(janes.street_address == "2 Marienplatz");
+  REQUIRE(janes.city == "Munich");
+  REQUIRE(janes.company_name == "Rathaus");
+  REQUIRE(janes.annual_income == 0);
+  REQUIRE(batch.size() == 2);
+  REQUIRE(batch[1].city == "Munich");
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "person_columns.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *const kCities[] = { "London", "Munich", "Paris" };
+
+void add_person(std::size_t i, PersonBatchBuilder &out)
+{
+  auto street = std::to_string(i) + " Main Street";
+  out.add(street, "", kCities[i % 3], "PragmaSoft", "", static_cast<int>(i));
+}
+
+}// namespace
+
+TEST_CASE("StringColumn appends strings and columns", "[builder]")
+{
+  StringColumn front, back;
+  front.push_back("London");
+  front.push_back("");
+  back.push_back("Munich");
+  front.append(back);
+
+  REQUIRE(front.size() == 3);
+  REQUIRE(front[0] == "London");
+  REQUIRE(front[1].empty());
+  REQUIRE(front[2] == "Munich");
+  REQUIRE(front.bytes == "LondonMunich");
+}
+
+TEST_CASE("PersonBatchBuilder merges keep the order and the city codes", "[builder]")
+{
+  PersonBatchBuilder front, back;
+  front.add("1 High Street", "", "London", "A", "", 100).add("2 High Street", "", "Munich", "B", "", 200);
+  // the cities come in another order, so their codes differ from those of front
+  back.add("3 High Street", "", "Paris", "C", "", 300).add("4 High Street", "", "London", "D", "", 400);
+  auto columns = std::move(front.merge(std::move(back))).build();
+
+  REQUIRE(columns.size() == 4);
+  REQUIRE(columns.cities.size() == 3);
+  std::vector<std::string> cities;
+  for (std::size_t i = 0; i < columns.size(); ++i) { cities.emplace_back(columns[i].city); }
+  REQUIRE(cities == std::vector<std::string>{ "London", "Munich", "Paris", "London" });
+  REQUIRE(columns[3].street_address == "4 High Street");
+  REQUIRE(columns.total_income() == 1000);
+
+  auto by_city = columns.income_by_city();
+  REQUIRE(by_city.size() == 3);
+  REQUIRE(by_city[0].city == "London");
+  REQUIRE(by_city[0].total == 500);
+  REQUIRE(by_city[0].count == 2);
+}
+
+TEST_CASE("PersonBatchBuilder::build_parallel matches a sequential build", "[builder]")
+{
+  // several chunks of at least 64k records
+  constexpr std::size_t kCount = 300'000;
+  ThreadPool pool{ 4 };
+  auto parallel = PersonBatchBuilder::build_parallel(kCount, add_person, pool);
+
+  PersonBatchBuilder builder;
+  for (std::size_t i = 0; i < kCount; ++i) { add_person(i, builder); }
+  auto sequential = std::move(builder).build();
+
+  REQUIRE(parallel.size() == kCount);
+  REQUIRE(parallel.street_address.bytes == sequential.street_address.bytes);
+  REQUIRE(parallel.street_address.offsets == sequential.street_address.offsets);
+  REQUIRE(parallel.city == sequential.city);
+  REQUIRE(parallel.annual_income == sequential.annual_income);
+  REQUIRE(parallel.total_income() == sequential.total_income());
+}
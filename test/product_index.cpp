@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "product_index.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// not backed by an index, the store has to check it product by product
+struct ShortNameSpecification : Specification<Product>
+{
+  bool is_satisfied(Product item) override { return item.name.size() < 5; }
+};
+
+std::vector<std::string> names_of(const std::vector<Product> &items)
+{
+  std::vector<std::string> result;
+  for (const auto &prd : items) { result.push_back(prd.name); }
+  return result;
+}
+
+}// namespace
+
+TEST_CASE("IndexedProductStore answers queries like BetterFilter", "[solid]")
+{
+  std::vector<Product> items;
+  for (std::size_t i = 0; i < 5'000; ++i) {
+    items.push_back({ "p" + std::to_string(i), static_cast<Color>(i % 3), static_cast<Size>((i / 3) % 3) });
+  }
+  IndexedProductStore store;
+  for (const auto &prd : items) { store.insert(prd); }
+  REQUIRE(store.size() == items.size());
+
+  ColorSpecification green{ Color::Green };
+  SizeSpecification large{ Size::Large };
+  ShortNameSpecification short_name;
+  auto green_and_large = green && large;
+  auto green_or_large = green || large;
+  auto not_green = !green;
+  // the planner evaluates the indexed side first and checks the generic one within it
+  auto short_and_green = short_name && green;
+  auto not_short = !short_name;
+  auto mixed = green_and_large || short_and_green;
+
+  BetterFilter bf;
+  for (Specification<Product> *spec : std::vector<Specification<Product> *>{ &green,
+         &large,
+         &short_name,
+         &green_and_large,
+         &green_or_large,
+         &not_green,
+         &short_and_green,
+         &not_short,
+         &mixed }) {
+    REQUIRE(names_of(store.filter(*spec)) == names_of(bf.filter(items, *spec)));
+    REQUIRE(store.query(*spec).cardinality() == bf.filter(items, *spec).size());
+  }
+}
+
+TEST_CASE("IndexedProductStore keeps indexes up to date on erase", "[solid]")
+{
+  IndexedProductStore store;
+  auto apple = store.insert({ "Apple", Color::Green, Size::Small });
+  auto tree = store.insert({ "Tree", Color::Green, Size::Large });
+  store.insert({ "House", Color::Blue, Size::Large });
+
+  ColorSpecification green{ Color::Green };
+  auto not_green = !green;
+  REQUIRE(store.query(green).cardinality() == 2);
+
+  REQUIRE(store.erase(tree));
+  REQUIRE_FALSE(store.erase(tree));
+  REQUIRE(store.size() == 2);
+  REQUIRE(names_of(store.filter(green)) == std::vector<std::string>{ "Apple" });
+  REQUIRE(names_of(store.filter(not_green)) == std::vector<std::string>{ "House" });
+
+  // the freed id is reused by the next product
+  REQUIRE(store.insert({ "Grass", Color::Green, Size::Small }) == tree);
+  REQUIRE(names_of(store.filter(green)) == std::vector<std::string>{ "Apple", "Grass" });
+  REQUIRE(store[apple].name == "Apple");
+}
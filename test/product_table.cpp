@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "product_table.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// matches names by their last digit, the columnar filter has no kernel for it
+struct EvenNameSpecification : Specification<Product>
+{
+  bool is_satisfied(Product item) override { return (item.name.back() - '0') % 2 == 0; }
+};
+
+std::vector<Product> catalogue(std::size_t count)
+{
+  std::vector<Product> items;
+  for (std::size_t i = 0; i < count; ++i) {
+    items.push_back({ "product" + std::to_string(i), static_cast<Color>(i % 3), static_cast<Size>((i / 3) % 3) });
+  }
+  return items;
+}
+
+std::vector<std::string> names_of(const std::vector<Product> &items)
+{
+  std::vector<std::string> result;
+  for (const auto &prd : items) { result.push_back(prd.name); }
+  return result;
+}
+
+std::vector<std::string> names_of(const ProductTable &table, const std::vector<ProductTable::index> &rows)
+{
+  std::vector<std::string> result;
+  for (auto row : rows) { result.emplace_back(table.name(row)); }
+  return result;
+}
+
+}// namespace
+
+TEST_CASE("ProductTable keeps the products it is built from", "[solid]")
+{
+  const auto items = catalogue(10);
+  const auto table = ProductTable::from(items);
+  REQUIRE(table.size() == items.size());
+  for (std::size_t row = 0; row < items.size(); ++row) {
+    const auto prd = table.product(row);
+    REQUIRE(prd.name == items[row].name);
+    REQUIRE(prd.color == items[row].color);
+    REQUIRE(prd.size == items[row].size);
+  }
+}
+
+TEST_CASE("ColumnarFilter selects the same products as BetterFilter", "[solid]")
+{
+  // more rows than in one block of the filter, and not a multiple of it
+  const auto items = catalogue(10'007);
+  const auto table = ProductTable::from(items);
+
+  ColorSpecification green{ Color::Green };
+  SizeSpecification large{ Size::Large };
+  EvenNameSpecification even;
+  auto green_and_large = green && large;
+  auto green_or_large = green || large;
+  auto not_green = !green;
+  auto even_and_not_green = even && not_green;
+  auto nested = green_and_large || even_and_not_green;
+
+  BetterFilter bf;
+  for (Specification<Product> *spec : std::vector<Specification<Product> *>{
+         &green, &large, &even, &green_and_large, &green_or_large, &not_green, &even_and_not_green, &nested }) {
+    const auto expected = names_of(bf.filter(items, *spec));
+    REQUIRE(names_of(table, ColumnarFilter::filter(table, *spec)) == expected);
+  }
+}
+
+TEST_CASE("ColumnarFilter works on an empty table", "[solid]")
+{
+  ProductTable table;
+  ColorSpecification red{ Color::Red };
+  REQUIRE(ColumnarFilter::filter(table, red).empty());
+}
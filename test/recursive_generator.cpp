@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "recursive_generator.h"
+
+#include <array>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+recursive_generator<int> range(int start, int end)
+{
+  for (; start < end; ++start) { co_yield start; }
+}
+
+// values from `start` in spans of `batch`, the buffer is refilled after each one
+recursive_generator<int> batches(int start, int end, int batch)
+{
+  std::vector<int> buffer(static_cast<std::size_t>(batch));
+  while (start < end) {
+    auto count = static_cast<std::size_t>(std::min(batch, end - start));
+    std::iota(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(count), start);
+    co_yield std::span<const int>(buffer.data(), count);
+    start += static_cast<int>(count);
+  }
+}
+
+recursive_generator<int> mixed()
+{
+  co_yield 0;
+  co_yield batches(1, 6, 2);
+  co_yield std::span<const int>{};
+  co_yield range(6, 8);
+  std::array<int, 3> tail{ 8, 9, 10 };
+  co_yield std::span<const int>(tail);
+}
+
+// `depth` generators nested into each other, each yields its depth on the way
+// back up; the innermost one throws instead if `fail` is set
+recursive_generator<int> nested(int depth, bool fail = false)
+{
+  if (depth == 0) {
+    if (fail) { throw std::runtime_error("innermost"); }
+    co_yield 0;
+    co_return;
+  }
+  co_yield nested(depth - 1, fail);
+  co_yield depth;
+}
+
+constexpr int kDeep = 1'000'000;
+
+}// namespace
+
+static_assert(std::input_iterator<recursive_generator<int>::iterator>);
+static_assert(std::input_iterator<recursive_generator<int>::chunk_iterator>);
+static_assert(std::ranges::input_range<recursive_generator<int>>);
+
+TEST_CASE("Spans are iterated one by one or in chunks", "[generator]")
+{
+  std::vector<int> values;
+  for (int v : mixed()) { values.push_back(v); }
+  std::vector<int> expected(11);
+  std::iota(expected.begin(), expected.end(), 0);
+  REQUIRE(values == expected);
+
+  std::vector<std::size_t> sizes;
+  values.clear();
+  for (auto chunk : mixed().chunks()) {
+    sizes.push_back(chunk.size());
+    values.insert(values.end(), chunk.begin(), chunk.end());
+  }
+  REQUIRE(values == expected);
+  REQUIRE(sizes == std::vector<std::size_t>{ 1, 2, 2, 1, 1, 1, 3 });
+}
+
+TEST_CASE("Generators compose with views", "[generator]")
+{
+  auto even = [](int v) { return v % 2 == 0; };
+  std::vector<int> values;
+  for (int v : batches(0, 100, 7) | std::views::filter(even) | std::views::take(4)) { values.push_back(v); }
+  REQUIRE(values == std::vector<int>{ 0, 2, 4, 6 });
+
+  auto gen = range(0, 3);
+  auto it = gen.begin();
+  REQUIRE(*it == 0);
+  it++;
+  REQUIRE(*it == 1);
+  REQUIRE(std::ranges::distance(it, gen.end()) == 2);
+}
+
+TEST_CASE("Nesting a million generators doesn't use up the stack", "[generator]")
+{
+  long long sum = 0;
+  int count = 0;
+  for (int v : nested(kDeep)) {
+    sum += v;
+    ++count;
+  }
+  REQUIRE(count == kDeep + 1);
+  REQUIRE(sum == static_cast<long long>(kDeep) * (kDeep + 1) / 2);
+
+  // left at the innermost value, all the generators are destroyed with the outer one
+  auto gen = nested(kDeep);
+  REQUIRE(*gen.begin() == 0);
+
+  // or when another generator is assigned to it
+  gen = nested(1);
+  std::vector<int> values;
+  for (int v : gen) { values.push_back(v); }
+  REQUIRE(values == std::vector<int>{ 0, 1 });
+}
+
+TEST_CASE("Exceptions of nested generators reach the consumer", "[generator]")
+{
+  auto gen = nested(kDeep, true);
+  REQUIRE_THROWS_AS(gen.begin(), std::runtime_error);
+
+  // thrown from operator++ after some values, the iterator is at its end then
+  auto failing = []() -> recursive_generator<int> {
+    co_yield 1;
+    co_yield nested(10, true);
+  }();
+  auto it = failing.begin();
+  REQUIRE(*it == 1);
+  REQUIRE_THROWS_AS(++it, std::runtime_error);
+  REQUIRE(it == failing.end());
+}
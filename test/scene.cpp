@@ -0,0 +1,114 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "scene.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// groups of groups of circles, every circle gets its radius from radius_of
+struct Layout
+{
+  std::size_t groups;
+  std::size_t subgroups;
+  std::size_t circles;
+};
+
+template<typename Radius> Scene build(const Layout &layout, Radius radius_of, std::vector<Scene::Node> *nodes = nullptr)
+{
+  Scene scene;
+  std::size_t i = 0;
+  for (std::size_t g = 0; g < layout.groups; ++g) {
+    auto group = scene.add_group("g" + std::to_string(g), scene.root());
+    for (std::size_t s = 0; s < layout.subgroups; ++s) {
+      auto subgroup = scene.add_group("s" + std::to_string(s), group);
+      for (std::size_t c = 0; c < layout.circles; ++c, ++i) {
+        auto node = scene.add_circle(radius_of(i), subgroup);
+        if (nodes) { nodes->push_back(node); }
+      }
+    }
+  }
+  return scene;
+}
+
+}// namespace
+
+TEST_CASE("Scene draws groups and circles in order", "[composite]")
+{
+  Scene scene;
+  scene.add_circle(1, scene.root());
+  auto sub = scene.add_group("sub", scene.root());
+  scene.add_circle(2.5F, sub);
+
+  REQUIRE(scene.draw() == "Group root contains:\nCircle 1\nGroup sub contains:\nCircle 2.5\n");
+}
+
+TEST_CASE("Scene re-emits dirty subtrees only", "[composite]")
+{
+  Scene scene;
+  auto first = scene.add_group("first", scene.root());
+  auto second = scene.add_group("second", scene.root());
+  auto inner = scene.add_group("inner", second);
+  scene.add_circle(1, first);
+  auto circle = scene.add_circle(2, inner);
+  scene.add_circle(3, second);
+
+  auto frame = scene.draw();
+  // nothing changed, the frame is the same buffer
+  REQUIRE(scene.draw().data() == frame.data());
+  scene.set_radius(circle, 2);
+  REQUIRE(scene.draw().data() == frame.data());
+
+  scene.set_radius(circle, 4);
+  REQUIRE(scene.draw()
+          == "Group root contains:\nGroup first contains:\nCircle 1\n"
+             "Group second contains:\nGroup inner contains:\nCircle 4\nCircle 3\n");
+  // a longer name moves everything after it, copied subtrees stay correct
+  scene.rename(first, "the first group");
+  scene.add_circle(5, inner);
+  REQUIRE(scene.draw()
+          == "Group root contains:\nGroup the first group contains:\nCircle 1\n"
+             "Group second contains:\nGroup inner contains:\nCircle 4\nCircle 5\nCircle 3\n");
+  scene.rename(first, "1st");
+  REQUIRE(scene.draw()
+          == "Group root contains:\nGroup 1st contains:\nCircle 1\n"
+             "Group second contains:\nGroup inner contains:\nCircle 4\nCircle 5\nCircle 3\n");
+}
+
+TEST_CASE("Scene checks the kind of nodes", "[composite]")
+{
+  Scene scene;
+  auto circle = scene.add_circle(1, scene.root());
+  auto group = scene.add_group("group", scene.root());
+
+  REQUIRE_THROWS_AS(scene.add_circle(1, circle), std::invalid_argument);
+  REQUIRE_THROWS_AS(scene.add_group("nested", circle), std::invalid_argument);
+  REQUIRE_THROWS_AS(scene.set_radius(group, 2), std::invalid_argument);
+  REQUIRE_THROWS_AS(scene.rename(circle, "circle"), std::invalid_argument);
+}
+
+TEST_CASE("Scene emits big subtrees in parallel the same way", "[composite]")
+{
+  // every group is bigger than the parallel cutoff, subgroups are not
+  const Layout layout{ 4, 100, 50 };
+  ThreadPool pool{ 3 };
+  std::vector<Scene::Node> nodes;
+  auto scene = build(layout, [](std::size_t) { return 1.0F; }, &nodes);
+  REQUIRE(scene.draw(pool) == build(layout, [](std::size_t) { return 1.0F; }).draw(pool));
+
+  // changes scattered over all groups, so every group is re-emitted on the pool
+  auto radius_of = [](std::size_t i) { return i % 997 == 0 ? 2.0F : 1.0F; };
+  for (std::size_t i = 0; i < nodes.size(); ++i) { scene.set_radius(nodes[i], radius_of(i)); }
+  auto expected = std::string{ build(layout, radius_of).draw(pool) };
+  REQUIRE(scene.draw(pool) == expected);
+
+  ThreadPool one{ 1 };
+  REQUIRE(build(layout, radius_of).draw(one) == expected);
+
+  // only the last group changes, the others are copied from the previous frame
+  auto last_changed = [&radius_of, &nodes](std::size_t i) { return i + 1 == nodes.size() ? 3.0F : radius_of(i); };
+  scene.set_radius(nodes.back(), 3.0F);
+  REQUIRE(scene.draw(pool) == build(layout, last_changed).draw(pool));
+}
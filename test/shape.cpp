@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "shape.h"
+
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace shapes;
+
+TEST_CASE("ShapeValue keeps shapes composed at compile time inline", "[decorator]")
+{
+  ShapeValue circle = Circle{ 5 };
+  REQUIRE_FALSE(circle.on_heap());
+  REQUIRE(to_string(circle) == "A circle of radius:5");
+
+  ShapeValue shape = Transparent{ Colored{ Circle{ 23 }, "green" }, 64 };
+  REQUIRE_FALSE(shape.on_heap());
+  REQUIRE(shape.layers_count() == 0);
+  REQUIRE(to_string(shape) == "A circle of radius:23 has the color green has 25.098% transparency");
+}
+
+TEST_CASE("ShapeValue keeps decorations added at run time as a flat list", "[decorator]")
+{
+  ShapeValue shape = Colored{ Circle{ 23 }, "green" };
+  ShapeValue red = Colored<>{ shape, "red" };
+  ShapeValue faded = Transparent<>{ Colored<>{ red, "blue" }, 255 };
+
+  // the circle stays inline, however many layers are on top of it
+  REQUIRE_FALSE(faded.on_heap());
+  REQUIRE(red.layers_count() == 1);
+  REQUIRE(faded.layers_count() == 3);
+  REQUIRE(to_string(red) == "A circle of radius:23 has the color green has the color red");
+  REQUIRE(to_string(faded)
+          == "A circle of radius:23 has the color green has the color red has the color blue has 100% transparency");
+  // the decorated value itself is untouched
+  REQUIRE(to_string(shape) == "A circle of radius:23 has the color green");
+
+  auto copy = faded;
+  auto moved = std::move(faded);
+  REQUIRE(to_string(copy) == to_string(moved));
+  REQUIRE(faded.empty());
+  copy = red;
+  REQUIRE(to_string(copy) == to_string(red));
+}
+
+TEST_CASE("format_to writes to a string or through an output iterator", "[decorator]")
+{
+  ShapeValue shape = Colored<>{ Circle{ 1.5F }, "red" };
+  constexpr std::string_view kText = "A circle of radius:1.5 has the color red";
+
+  std::string text = "> ";
+  format_to(text, shape);
+  REQUIRE(text == std::string{ "> " }.append(kText));
+
+  char buf[64];
+  auto *end = format_to(buf, shape);
+  REQUIRE(std::string_view(buf, static_cast<std::size_t>(end - buf)) == kText);
+
+  std::string appended;
+  format_to(std::back_inserter(appended), shape);
+  REQUIRE(appended == kText);
+}
@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "solid.h"
+
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace {
+
+std::vector<int> numbers(int count)
+{
+  std::vector<int> items(static_cast<std::size_t>(count));
+  std::iota(items.begin(), items.end(), 0);
+  return items;
+}
+
+bool divisible_by_7(const int &value) { return value % 7 == 0; }
+
+}// namespace
+
+TEST_CASE("LambdaFilter parallel overloads keep the order of the sequential one", "[solid]")
+{
+  ThreadPool pool{ 3 };
+  // a few chunks and a tail which doesn't fill a chunk
+  const auto items = numbers(100'003);
+  const auto expected = LambdaFilter<int>::filter(exec::seq, items, divisible_by_7);
+  REQUIRE(expected.size() == 14'287);
+
+  REQUIRE(LambdaFilter<int>::filter(exec::par(pool), items, divisible_by_7) == expected);
+  REQUIRE(LambdaFilter<int>::filter(exec::par_unseq(pool), items, divisible_by_7) == expected);
+  REQUIRE(LambdaFilter<int>::filter(exec::par, std::span<const int>(items), divisible_by_7) == expected);
+  REQUIRE(LambdaFilter<int>::filter(exec::par_unseq, items, divisible_by_7) == expected);
+}
+
+TEST_CASE("LambdaFilter parallel overloads work on small and empty ranges", "[solid]")
+{
+  const std::vector<int> empty;
+  REQUIRE(LambdaFilter<int>::filter(exec::par, empty, divisible_by_7).empty());
+  REQUIRE(LambdaFilter<int>::filter(exec::par_unseq, empty, divisible_by_7).empty());
+  REQUIRE(LambdaFilter<int>::filter(exec::par, numbers(10), divisible_by_7) == std::vector<int>{ 0, 7 });
+}
+
+TEST_CASE("LambdaFilter::stream yields matches lazily", "[solid]")
+{
+  SECTION("from a container it references")
+  {
+    const auto items = numbers(30);
+    std::vector<int> found;
+    for (int value : LambdaFilter<int>::stream(items, divisible_by_7)) { found.push_back(value); }
+    REQUIRE(found == std::vector<int>{ 0, 7, 14, 21, 28 });
+  }
+  SECTION("from a temporary container it owns")
+  {
+    auto gen = LambdaFilter<int>::stream(numbers(30), divisible_by_7);
+    std::vector<int> found;
+    for (int value : gen) { found.push_back(value); }
+    REQUIRE(found == std::vector<int>{ 0, 7, 14, 21, 28 });
+  }
+  SECTION("from an unbounded range")
+  {
+    std::vector<int> found;
+    for (int value : LambdaFilter<int>::stream(std::views::iota(1), divisible_by_7)) {
+      found.push_back(value);
+      if (found.size() == 3) { break; }
+    }
+    REQUIRE(found == std::vector<int>{ 7, 14, 21 });
+  }
+}
@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "string_interner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> numbered(const std::string &prefix, std::size_t count)
+{
+  std::vector<std::string> strings;
+  for (std::size_t i = 0; i < count; ++i) { strings.push_back(prefix + std::to_string(i)); }
+  return strings;
+}
+
+}// namespace
+
+TEST_CASE("StringInterner gives one id per string from many threads", "[string_interner]")
+{
+  constexpr std::size_t kThreads = 4;
+  constexpr std::size_t kStrings = 20'000;
+  StringInterner interner{ 8 };
+  auto strings = numbered("s", kStrings);
+
+  // every thread interns all the strings, starting at a different place
+  std::vector<std::vector<StringInterner::id>> ids(kThreads, std::vector<StringInterner::id>(kStrings));
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (std::size_t n = 0; n < kStrings; ++n) {
+        auto i = (n + t * kStrings / kThreads) % kStrings;
+        ids[t][i] = interner.intern(strings[i]);
+        if (interner[ids[t][i]] != strings[i]) { ids[t][i] = UINT32_MAX; }
+      }
+    });
+  }
+  for (auto &thread : threads) { thread.join(); }
+
+  REQUIRE(interner.size() == kStrings);
+  for (std::size_t t = 1; t < kThreads; ++t) { REQUIRE(ids[t] == ids[0]); }
+  // ids are dense
+  std::vector<bool> seen(kStrings);
+  for (std::size_t i = 0; i < kStrings; ++i) {
+    REQUIRE(ids[0][i] < kStrings);
+    REQUIRE(interner[ids[0][i]] == strings[i]);
+    seen[ids[0][i]] = true;
+  }
+  REQUIRE(std::find(seen.begin(), seen.end(), false) == seen.end());
+}
+
+TEST_CASE("StringInterner interns in bulk and counts what was shared", "[string_interner]")
+{
+  StringInterner interner{ 4 };
+  auto first = interner.intern("John");
+  REQUIRE(interner.intern("John") == first);
+
+  const std::vector<std::string_view> batch{ "Jane", "Doe", "John", "Doe", "" };
+  std::vector<StringInterner::id> ids(batch.size());
+  interner.intern_bulk(batch, ids);
+  REQUIRE(ids[2] == first);
+  REQUIRE(ids[1] == ids[3]);
+  for (std::size_t i = 0; i < batch.size(); ++i) { REQUIRE(interner[ids[i]] == batch[i]); }
+  REQUIRE(interner.size() == 4);
+
+  auto stats = interner.statistics();
+  REQUIRE(stats.unique == 4);
+  REQUIRE(stats.interned == 7);
+  REQUIRE(stats.unique_bytes == 11);
+  REQUIRE(stats.requested_bytes == 22);
+  REQUIRE(stats.bytes_saved() == 11);
+
+  // more than one block of the bulk insert, with strings already there
+  auto strings = numbered("s", 10'000);
+  interner.intern("s42");
+  std::vector<std::string_view> many(strings.begin(), strings.end());
+  ids.resize(many.size());
+  interner.intern_bulk(many, ids);
+  REQUIRE(interner.size() == 4 + many.size());
+  for (std::size_t i = 0; i < many.size(); ++i) { REQUIRE(interner[ids[i]] == many[i]); }
+
+  std::vector<StringInterner::id> too_few(2);
+  REQUIRE_THROWS_AS(interner.intern_bulk(batch, too_few), std::invalid_argument);
+}
+
+TEST_CASE("StringInterner names are read while others are interned", "[string_interner]")
+{
+  constexpr std::size_t kStrings = 50'000;
+  StringInterner interner{ 2 };
+  auto known = interner.intern("known");
+  auto strings = numbered("s", kStrings);
+
+  std::atomic<bool> done{ false };
+  std::thread writer{ [&] {
+    for (std::size_t i = 0; i < kStrings; i += 100) {
+      std::vector<StringInterner::id> ids(100);
+      std::vector<std::string_view> batch(strings.begin() + static_cast<std::ptrdiff_t>(i),
+        strings.begin() + static_cast<std::ptrdiff_t>(i + 100));
+      interner.intern_bulk(batch, ids);
+    }
+    done = true;
+  } };
+  std::size_t reads = 0;
+  bool same = true;
+  while (!done) {
+    same = same && interner[known] == "known";
+    ++reads;
+  }
+  writer.join();
+
+  REQUIRE(same);
+  REQUIRE(reads > 0);
+  REQUIRE(interner.size() == kStrings + 1);
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "string_pool.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> numbered(const std::string &prefix, std::size_t count)
+{
+  std::vector<std::string> strings;
+  for (std::size_t i = 0; i < count; ++i) { strings.push_back(prefix + std::to_string(i)); }
+  return strings;
+}
+
+// a pool file in the temporary directory, removed at the end of the test
+struct TempPool
+{
+  std::string path;
+
+  explicit TempPool(const std::vector<std::string> &strings)
+    : path{ (std::filesystem::temp_directory_path() / "string_pool_test.pool").string() }
+  {
+    std::vector<std::string_view> views(strings.begin(), strings.end());
+    string_pool::write(path, views);
+  }
+  ~TempPool() { std::filesystem::remove(path); }
+
+  TempPool(const TempPool &) = delete;
+  TempPool &operator=(const TempPool &) = delete;
+
+  void overwrite(std::size_t at, std::uint32_t value) const
+  {
+    std::fstream file{ path, std::ios::in | std::ios::out | std::ios::binary };
+    file.seekp(static_cast<std::streamoff>(at));
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+};
+
+// where the parts of a file start, see the layout in string_pool.h
+constexpr std::size_t kHeaderSize = 32;
+std::size_t index_start(std::size_t count) { return kHeaderSize + ((count + 1) * 4 + 7) / 8 * 8; }
+
+}// namespace
+
+#ifndef _WIN32
+
+TEST_CASE("MappedStringPool reads what was written and adds new strings to the overlay", "[string_pool]")
+{
+  auto strings = numbered("name", 1000);
+  TempPool file{ strings };
+  MappedStringPool pool{ file.path };
+
+  REQUIRE(pool.size() == strings.size());
+  for (std::uint32_t i = 0; i < strings.size(); ++i) {
+    REQUIRE(pool[i] == strings[i]);
+    MappedStringPool::id found = 0;
+    REQUIRE(pool.find(strings[i], found));
+    REQUIRE(found == i);
+    REQUIRE(pool.intern(strings[i]) == i);
+  }
+
+  MappedStringPool::id found = 0;
+  REQUIRE_FALSE(pool.find("new", found));
+  auto fresh = pool.intern("new");
+  REQUIRE(fresh == strings.size());
+  REQUIRE(pool.intern("new") == fresh);
+  REQUIRE(pool.find("new", found));
+  REQUIRE(found == fresh);
+  REQUIRE(pool[fresh] == "new");
+  REQUIRE(pool.overlay_size() == 1);
+}
+
+TEST_CASE("MappedStringPool compaction keeps the ids", "[string_pool]")
+{
+  auto strings = numbered("name", 100);
+  TempPool file{ strings };
+  std::vector<MappedStringPool::id> added;
+  {
+    MappedStringPool pool{ file.path };
+    for (const auto &text : numbered("added", 50)) { added.push_back(pool.intern(text)); }
+    pool.compact();
+
+    REQUIRE(pool.file_size() == 150);
+    REQUIRE(pool.overlay_size() == 0);
+    REQUIRE(pool[added.front()] == "added0");
+    REQUIRE(pool.intern("added49") == added.back());
+  }
+
+  // the added strings are in the file now
+  MappedStringPool reopened{ file.path };
+  REQUIRE(reopened.file_size() == 150);
+  REQUIRE(reopened[0] == "name0");
+  MappedStringPool::id found = 0;
+  REQUIRE(reopened.find("added7", found));
+  REQUIRE(found == added[7]);
+}
+
+TEST_CASE("MappedStringPool rejects corrupt files", "[string_pool]")
+{
+  auto strings = numbered("name", 10);
+  {
+    TempPool file{ strings };
+    // the second string ends beyond the blob
+    file.overwrite(kHeaderSize + 2 * 4, 1'000'000);
+    REQUIRE_THROWS(MappedStringPool{ file.path });
+  }
+  {
+    TempPool file{ strings };
+    // offsets go back
+    file.overwrite(kHeaderSize + 2 * 4, 1);
+    REQUIRE_THROWS(MappedStringPool{ file.path });
+  }
+  {
+    TempPool file{ strings };
+    // a slot refers to a string which isn't there
+    for (std::size_t slot = 0; slot < 32; ++slot) { file.overwrite(index_start(10) + slot * 8 + 4, 11); }
+    REQUIRE_THROWS(MappedStringPool{ file.path });
+  }
+  {
+    TempPool file{ strings };
+    REQUIRE_NOTHROW(MappedStringPool{ file.path });
+  }
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+TEST_CASE("ThreadPool runs queued tasks before it is destroyed", "[thread_pool]")
+{
+  std::atomic<int> done{ 0 };
+  {
+    ThreadPool pool{ 1 };
+    // the first task keeps the only worker busy while the rest are queued
+    pool.submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+    for (int i = 0; i < 100; ++i) {
+      pool.submit([&done] { done.fetch_add(1); });
+    }
+  }
+  REQUIRE(done.load() == 100);
+}
+
+TEST_CASE("TaskGroup waited for outside of the pool gets all results", "[thread_pool]")
+{
+  ThreadPool pool{ 2 };
+  std::atomic<int> done{ 0 };
+  TaskGroup group{ pool };
+  for (int i = 0; i < 8; ++i) {
+    group.run([&done] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      done.fetch_add(1);
+    });
+  }
+  group.wait();
+  REQUIRE(done.load() == 8);
+}
+
+TEST_CASE("TaskGroup can be waited for from inside of the pool", "[thread_pool]")
+{
+  ThreadPool pool{ 1 };
+  std::atomic<int> done{ 0 };
+  TaskGroup outer{ pool };
+  for (int i = 0; i < 4; ++i) {
+    outer.run([&pool, &done] {
+      // the only worker waits for tasks which nobody else can run
+      TaskGroup inner{ pool };
+      for (int j = 0; j < 4; ++j) {
+        inner.run([&done] { done.fetch_add(1); });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  REQUIRE(done.load() == 16);
+}
+
+TEST_CASE("TaskGroup rethrows the first exception", "[thread_pool]")
+{
+  ThreadPool pool{ 2 };
+  TaskGroup group{ pool };
+  group.run([] { throw std::runtime_error("failed"); });
+  group.run([] {});
+  REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+  // the error is reported once
+  REQUIRE_NOTHROW(group.wait());
+}